@@ -0,0 +1,98 @@
+/**
+ * @file BackendBench.cpp
+ * @brief 以相同的图像对比各推理后端与模型的加载时间与单帧推理耗时
+ *
+ * 用法: BackendBench <image dir> <model> [model ...]
+ * 例如 BackendBench images Detector/model/opt-0517-001.xml Detector/model/yolox.onnx
+ * 每个模型依次使用 OPENVINO 与 OPENCV 后端，网络输入为模型原始尺寸（OpenCV DNN 为 416x416）。
+ * OPENCV 后端只加载 ONNX 模型，IR 模型只测试 OPENVINO。
+ * 同时统计置信度超过阈值的候选数，同一模型在不同后端上应基本一致。
+ */
+#include "ArmorDetector/InferBackend.hpp"
+#include "ArmorDetector/Preprocess.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace armor_detector;
+
+static constexpr float BBOX_CONF_THRESH = 0.6;
+static constexpr int WARMUP_ITERATIONS = 3;
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        cout << "Usage: " << argv[0] << " <image dir> <model> [model ...]" << endl;
+        return 1;
+    }
+
+    std::vector<cv::String> image_paths;
+    cv::glob(std::string(argv[1]) + "/*.jpg", image_paths);
+    std::vector<cv::String> png_paths;
+    cv::glob(std::string(argv[1]) + "/*.png", png_paths);
+    image_paths.insert(image_paths.end(), png_paths.begin(), png_paths.end());
+
+    std::vector<cv::Mat> images;
+    for (const auto &path : image_paths)
+    {
+        images.push_back(cv::imread(path));
+        if (images.back().empty())
+            images.pop_back();
+    }
+    if (images.empty())
+    {
+        cout << " ERROR: " << argv[1] << " 中没有图像" << endl;
+        return 1;
+    }
+    cout << images.size() << " images" << endl;
+
+    LetterboxKernel letterbox;
+    Eigen::Matrix<float, 3, 3> transform_matrix;
+    for (int m = 2; m < argc; m++)
+    {
+        for (const std::string name : {"OPENVINO", "OPENCV"})
+        {
+            auto t1 = std::chrono::steady_clock::now();
+            std::unique_ptr<InferBackend> backend = createInferBackend(name, "CPU");
+            if (!backend->load(argv[m], 0, 0))
+                continue;
+            auto t2 = std::chrono::steady_clock::now();
+            const double load_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+            const cv::Size input_size = backend->inputSize();
+            for (int i = 0; i < WARMUP_ITERATIONS; i++)
+                backend->infer();
+
+            std::vector<double> infer_ms;
+            int candidates = 0;
+            for (auto &image : images)
+            {
+                letterbox.run(image, backend->input(), input_size.width, input_size.height, transform_matrix);
+                t1 = std::chrono::steady_clock::now();
+                backend->infer();
+                t2 = std::chrono::steady_clock::now();
+                infer_ms.push_back(std::chrono::duration<double, std::milli>(t2 - t1).count());
+
+                const float *output = backend->output();
+                for (int a = 0; a < backend->numAnchors(); a++)
+                    candidates += output[a * backend->outputDim() + 8] >= BBOX_CONF_THRESH;
+            }
+
+            std::sort(infer_ms.begin(), infer_ms.end());
+            double mean_ms = 0;
+            for (double ms : infer_ms)
+                mean_ms += ms;
+            mean_ms /= infer_ms.size();
+            const double p99_ms = infer_ms[std::min(infer_ms.size() - 1, infer_ms.size() * 99 / 100)];
+
+            cout << name << " " << argv[m] << " (" << input_size.width << "x" << input_size.height
+                 << "): load " << load_ms << " ms, infer mean " << mean_ms << " ms, p99 " << p99_ms << " ms, "
+                 << candidates << " candidates" << endl;
+        }
+    }
+
+    return 0;
+}
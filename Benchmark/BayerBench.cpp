@@ -0,0 +1,211 @@
+/**
+ * @file BayerBench.cpp
+ * @brief 用合成的拜耳图像验证 BayerKernel，并与 全分辨率去马赛克 + LetterboxKernel 对比耗时
+ *
+ * 用法: BayerBench [image] [iterations]
+ * 由BGR图像按四种拜耳排列与白平衡增益的倒数生成原始图像，不需要相机。不指定图像时使用随机生成的平滑 1280x1024 图像。
+ * 每种排列分别检查整帧、奇数偏移的缩小ROI与原始分辨率裁剪（ROI、分块模式），超出容差时返回1。
+ * 缩小时与 单元合成 + cv::resize(INTER_AREA) 的参考结果逐元素比较，
+ * 原始分辨率裁剪与 cv::cvtColor 完整去马赛克 + cv::resize(INTER_LINEAR) 的参考结果比较。
+ */
+#include "ArmorDetector/Preprocess.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+static constexpr int INPUT_W = 416;
+static constexpr int INPUT_H = 416;
+static constexpr float TOLERANCE = 1e-3f;
+
+static const Scalar GAINS(1.05, 1.30, 1.45);
+static const char *PATTERNS[] = {"BGGR", "GBRG", "GRBG", "RGGB"};
+// 与 PATTERNS 对应的 cv::cvtColor 代码
+static const int BGR_CODES[] = {COLOR_BayerRG2BGR, COLOR_BayerGR2BGR, COLOR_BayerGB2BGR, COLOR_BayerBG2BGR};
+
+/**
+ * @brief Channel (0 B / 1 G / 2 R) of pixel (x, y) in a full frame with the given pattern.
+ */
+static int colorAt(const string &pattern, int x, int y)
+{
+    const char c = pattern[(y & 1) * 2 + (x & 1)];
+    return c == 'B' ? 0 : c == 'G' ? 1 : 2;
+}
+
+/**
+ * @brief Sample a BGR image through the color filter and undo the white balance, like the sensor would see it.
+ */
+static Mat mosaic(const Mat &bgr, const string &pattern)
+{
+    Mat raw(bgr.size(), CV_8UC1);
+    for (int y = 0; y < bgr.rows; y++)
+        for (int x = 0; x < bgr.cols; x++)
+        {
+            const int c = colorAt(pattern, x, y);
+            raw.at<uchar>(y, x) = saturate_cast<uchar>(bgr.at<Vec3b>(y, x)[c] / GAINS[c]);
+        }
+    return raw;
+}
+
+/**
+ * @brief Pad a resized image to the network input and split it into planes.
+ */
+static void padAndSplit(const Mat &resized, const armor_detector::LetterboxGeometry &geometry, float *dst)
+{
+    Mat padded;
+    copyMakeBorder(resized, padded, geometry.pad_top, INPUT_H - geometry.pad_top - geometry.unpad_h,
+                   geometry.pad_left, INPUT_W - geometry.pad_left - geometry.unpad_w, BORDER_CONSTANT);
+
+    Mat planes[3];
+    split(padded, planes);
+    for (int c = 0; c < 3; c++)
+        memcpy(dst + c * INPUT_W * INPUT_H, planes[c].data, INPUT_W * INPUT_H * sizeof(float));
+}
+
+/**
+ * @brief Straightforward reference of BayerKernel::run.
+ * Downscaling merges cells, cv::resize(INTER_AREA), pads and splits. Native resolution crops are demosaiced with
+ * cv::cvtColor and letterboxed with cv::resize(INTER_LINEAR).
+ * @param raw Source image, may be a ROI of a larger frame.
+ * @param pattern Pattern of the full frame.
+ * @param dst Network input memory, 3 * INPUT_W * INPUT_H floats in CHW order.
+ */
+static void reference(const Mat &raw, const string &pattern, float *dst)
+{
+    Size whole;
+    Point ofs;
+    raw.locateROI(whole, ofs);
+
+    armor_detector::LetterboxGeometry cell_geometry(raw.cols / 2 * 2, raw.rows / 2 * 2, INPUT_W, INPUT_H);
+    if (cell_geometry.unpad_w > raw.cols / 2 || cell_geometry.unpad_h > raw.rows / 2)
+    {
+        // 裁剪左上角的滤色片排列
+        string crop_pattern;
+        for (int i = 0; i < 4; i++)
+            crop_pattern += "BGR"[colorAt(pattern, (i & 1) + ofs.x, (i >> 1) + ofs.y)];
+        const int code = BGR_CODES[find(begin(PATTERNS), end(PATTERNS), crop_pattern) - begin(PATTERNS)];
+
+        Mat bgr, bgr_f, resized;
+        cvtColor(raw, bgr, code);
+        // BayerKernel 以float保存增益
+        multiply(bgr, Scalar((float)GAINS[0], (float)GAINS[1], (float)GAINS[2]), bgr);
+        bgr.convertTo(bgr_f, CV_32F);
+        armor_detector::LetterboxGeometry geometry(raw.cols, raw.rows, INPUT_W, INPUT_H);
+        resize(bgr_f, resized, Size(geometry.unpad_w, geometry.unpad_h), 0, 0, INTER_LINEAR);
+        padAndSplit(resized, geometry, dst);
+        return;
+    }
+
+    Mat cells(raw.rows / 2, raw.cols / 2, CV_32FC3, Scalar::all(0));
+    for (int y = 0; y < cells.rows * 2; y++)
+        for (int x = 0; x < cells.cols * 2; x++)
+        {
+            const int c = colorAt(pattern, x + ofs.x, y + ofs.y);
+            cells.at<Vec3f>(y / 2, x / 2)[c] += raw.at<uchar>(y, x) * (c == 1 ? 0.5f : 1.f);
+        }
+    for (auto it = cells.begin<Vec3f>(); it != cells.end<Vec3f>(); ++it)
+        for (int c = 0; c < 3; c++)
+            (*it)[c] = std::min((float)((*it)[c] * GAINS[c]), 255.f);
+
+    Mat resized;
+    resize(cells, resized, Size(cell_geometry.unpad_w, cell_geometry.unpad_h), 0, 0, INTER_AREA);
+    padAndSplit(resized, cell_geometry, dst);
+}
+
+static float maxDiff(const vector<float> &a, const vector<float> &b)
+{
+    float diff = 0.f;
+    for (size_t i = 0; i < a.size(); i++)
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    return diff;
+}
+
+static float meanDiff(const vector<float> &a, const vector<float> &b)
+{
+    double diff = 0;
+    for (size_t i = 0; i < a.size(); i++)
+        diff += std::abs(a[i] - b[i]);
+    return diff / a.size();
+}
+
+template <typename F> static double timeIt(int iterations, F &&f)
+{
+    f(); // warm up
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count() / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    Mat src;
+    if (argc > 1)
+        src = imread(argv[1]);
+    if (src.empty())
+    {
+        // 纯随机噪声没有可供插值的颜色结构，模糊后更接近真实图像
+        src.create(1024, 1280, CV_8UC3);
+        randu(src, Scalar::all(0), Scalar::all(255));
+        GaussianBlur(src, src, Size(0, 0), 3);
+    }
+    int iterations = argc > 2 ? atoi(argv[2]) : 500;
+
+    vector<float> kernel_blob(3 * INPUT_W * INPUT_H);
+    vector<float> reference_blob(3 * INPUT_W * INPUT_H);
+    vector<float> isp_blob(3 * INPUT_W * INPUT_H);
+    vector<float> truth_blob(3 * INPUT_W * INPUT_H);
+    Eigen::Matrix<float, 3, 3> kernel_matrix;
+    Eigen::Matrix<float, 3, 3> isp_matrix;
+    armor_detector::LetterboxKernel letterbox;
+    letterbox.run(src, truth_blob.data(), INPUT_W, INPUT_H, isp_matrix);
+
+    cout << "input: " << src.cols << "x" << src.rows << " -> " << INPUT_W << "x" << INPUT_H << ", " << iterations
+         << " iterations" << endl;
+
+    bool passed = true;
+    for (const char *pattern : PATTERNS)
+    {
+        armor_detector::BayerKernel bayer;
+        bayer.setFormat(pattern, GAINS);
+        Mat raw = mosaic(src, pattern);
+
+        // 整帧、奇数偏移的缩小ROI与原始分辨率裁剪（滤色片相位随偏移变化）
+        const Rect rois[] = {Rect(0, 0, raw.cols, raw.rows), Rect(101, 51, raw.cols - 201, raw.rows - 101),
+                             Rect(101, 51, INPUT_W, INPUT_H)};
+        float diff = 0.f;
+        for (const Rect &roi : rois)
+        {
+            bayer.run(raw(roi), kernel_blob.data(), INPUT_W, INPUT_H, kernel_matrix);
+            reference(raw(roi), pattern, reference_blob.data());
+            diff = std::max(diff, maxDiff(kernel_blob, reference_blob));
+        }
+        passed &= diff <= TOLERANCE;
+
+        // 全分辨率去马赛克后再缩放（相机ISP输出BGR时的流程）
+        Mat bgr;
+        double isp_ms = timeIt(iterations, [&] {
+            bayer.toBgr(raw, bgr);
+            letterbox.run(bgr, isp_blob.data(), INPUT_W, INPUT_H, isp_matrix);
+        });
+        double bayer_ms =
+            timeIt(iterations, [&] { bayer.run(raw, kernel_blob.data(), INPUT_W, INPUT_H, kernel_matrix); });
+
+        cout << pattern << ": max abs diff to reference " << diff << (diff <= TOLERANCE ? " (ok)" : " (FAILED)")
+             << endl;
+        cout << "  demosaic + letterbox: " << isp_ms << " ms/frame, mean abs diff to source "
+             << meanDiff(isp_blob, truth_blob) << endl;
+        cout << "  fused bayer         : " << bayer_ms << " ms/frame (x" << isp_ms / bayer_ms
+             << "), mean abs diff to source " << meanDiff(kernel_blob, truth_blob)
+             << ", transform diff: " << (isp_matrix - kernel_matrix).norm() << endl;
+    }
+
+    return passed ? 0 : 1;
+}
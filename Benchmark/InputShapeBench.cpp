@@ -0,0 +1,83 @@
+/**
+ * @file InputShapeBench.cpp
+ * @brief 对比正方形与非正方形网络输入的单帧耗时与召回率
+ *
+ * 用法: InputShapeBench <model.xml> <detector.xml> <image dir> [WxH ...]
+ * 默认对比 416x416、416x320 与 448x352。识别器配置应关闭 ROI_MODE，保证每张图像都在全图上推理。
+ * 图像同目录下若存在同名 .txt 标注（每行: 类别 x1 y1 x2 y2 x3 y3 x4 y4，归一化坐标），召回率以标注为准；
+ * 否则以第一个成功加载的输入尺寸的识别结果为参考。
+ */
+#include "ArmorDetector/ArmorDetector.hpp"
+#include "LabelSet.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace armor_detector;
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        cout << "Usage: " << argv[0] << " <model.xml> <detector.xml> <image dir> [WxH ...]" << endl;
+        return 1;
+    }
+
+    std::vector<cv::Size> shapes;
+    for (int i = 4; i < argc; i++)
+    {
+        int w = 0, h = 0;
+        if (sscanf(argv[i], "%dx%d", &w, &h) == 2)
+            shapes.emplace_back(w, h);
+    }
+    if (shapes.empty())
+        shapes = {cv::Size(416, 416), cv::Size(416, 320), cv::Size(448, 352)};
+
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<ArmorLabel>> labels;
+    bool labeled = readImageSet(argv[3], images, labels);
+    if (images.empty())
+    {
+        cout << " ERROR: " << argv[3] << " 中没有图像" << endl;
+        return 1;
+    }
+    cout << images.size() << " images, recall against " << (labeled ? "labels" : "the first input size") << endl;
+
+    std::vector<ArmorObject> objects;
+    bool has_reference = labeled;
+    for (size_t s = 0; s < shapes.size(); s++)
+    {
+        ArmorDetector detector;
+        detector.readConfig(argv[2]);
+        detector.setInputSize(shapes[s]);
+        if (!detector.initModel(argv[1]))
+            continue;
+        detector.warmup(images[0].size());
+
+        double total_ms = 0;
+        int total_ref = 0, total_matched = 0;
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            auto t1 = std::chrono::steady_clock::now();
+            detector.detect(images[i], objects);
+            auto t2 = std::chrono::steady_clock::now();
+            total_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+            // 无标注时第一个输入尺寸的结果作为参考
+            if (!has_reference)
+                appendReference(objects, labels[i]);
+
+            total_ref += labels[i].size();
+            total_matched += countMatched(labels[i], objects);
+        }
+        has_reference = true;
+
+        cout << shapes[s].width << "x" << shapes[s].height << ": " << total_ms / images.size() << " ms/frame, recall "
+             << (total_ref > 0 ? 100.0 * total_matched / total_ref : 0.0) << "% (" << total_matched << "/"
+             << total_ref << ")" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file LabelSet.hpp
+ * @brief 评测工具共用的图像集读取与四点标注匹配
+ *
+ * 图像同目录下的同名 .txt 为标注，每行: 类别 x1 y1 x2 y2 x3 y3 x4 y4（归一化坐标，角点顺序与网络输出一致）。
+ */
+#ifndef YOLOXARMOR_LABEL_SET_H
+#define YOLOXARMOR_LABEL_SET_H
+
+#include "ArmorDetector/ArmorObject.hpp"
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace armor_detector
+{
+
+static constexpr float MATCH_IOU = 0.5;
+
+struct ArmorLabel
+{
+    int cls = 0;         // 类别
+    cv::Point2f apex[4]; // 四个角点（像素坐标）
+};
+
+inline cv::Rect_<float> apexRect(const cv::Point2f apex[4])
+{
+    float x_min = apex[0].x, x_max = apex[0].x, y_min = apex[0].y, y_max = apex[0].y;
+    for (int i = 1; i < 4; i++)
+    {
+        x_min = std::min(x_min, apex[i].x);
+        x_max = std::max(x_max, apex[i].x);
+        y_min = std::min(y_min, apex[i].y);
+        y_max = std::max(y_max, apex[i].y);
+    }
+    return cv::Rect_<float>(x_min, y_min, x_max - x_min, y_max - y_min);
+}
+
+inline float rectIou(const cv::Rect_<float> &a, const cv::Rect_<float> &b)
+{
+    float inter = (a & b).area();
+    return inter / (a.area() + b.area() - inter);
+}
+
+/**
+ * @brief 读取图像对应的四点标注，不存在时返回false
+ */
+inline bool readLabels(const std::string &image_path, const cv::Size &size, std::vector<ArmorLabel> &labels)
+{
+    labels.clear();
+    std::ifstream ifs(image_path.substr(0, image_path.find_last_of('.')) + ".txt");
+    if (!ifs.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+        ArmorLabel label;
+        if (!(iss >> label.cls))
+            continue;
+        for (int i = 0; i < 4; i++)
+        {
+            iss >> label.apex[i].x >> label.apex[i].y;
+            label.apex[i].x *= size.width;
+            label.apex[i].y *= size.height;
+        }
+        if (iss)
+            labels.push_back(label);
+    }
+    return true;
+}
+
+/**
+ * @brief 读取目录下的 jpg/png 图像及其标注
+ * @return 全部图像都有标注时返回true，否则清空标注并返回false
+ */
+inline bool readImageSet(const std::string &dir, std::vector<cv::Mat> &images,
+                         std::vector<std::vector<ArmorLabel>> &labels)
+{
+    std::vector<cv::String> image_paths;
+    cv::glob(dir + "/*.jpg", image_paths);
+    std::vector<cv::String> png_paths;
+    cv::glob(dir + "/*.png", png_paths);
+    image_paths.insert(image_paths.end(), png_paths.begin(), png_paths.end());
+
+    images.clear();
+    labels.assign(image_paths.size(), std::vector<ArmorLabel>());
+    bool labeled = !image_paths.empty();
+    for (size_t i = 0; i < image_paths.size(); i++)
+    {
+        images.push_back(cv::imread(image_paths[i]));
+        labeled = readLabels(image_paths[i], images.back().size(), labels[i]) && labeled;
+    }
+    if (!labeled)
+        for (auto &image_labels : labels)
+            image_labels.clear();
+    return labeled;
+}
+
+/**
+ * @brief 以识别结果作为参考标注
+ */
+inline void appendReference(const std::vector<ArmorObject> &objects, std::vector<ArmorLabel> &labels)
+{
+    for (const auto &object : objects)
+    {
+        ArmorLabel label;
+        label.cls = object.cls;
+        for (int i = 0; i < 4; i++)
+            label.apex[i] = object.apex[i];
+        labels.push_back(label);
+    }
+}
+
+/**
+ * @brief 按IoU贪心匹配，返回被命中的标注数量
+ * @param corner_error 累加命中标注的平均角点误差（像素），可为空
+ */
+inline int countMatched(const std::vector<ArmorLabel> &labels, const std::vector<ArmorObject> &objects,
+                        double *corner_error = nullptr)
+{
+    std::vector<bool> used(objects.size(), false);
+    int matched = 0;
+    for (const auto &label : labels)
+    {
+        const cv::Rect_<float> label_rect = apexRect(label.apex);
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            if (used[i] || rectIou(label_rect, apexRect(objects[i].apex)) < MATCH_IOU)
+                continue;
+
+            used[i] = true;
+            matched++;
+            if (corner_error)
+            {
+                double error = 0;
+                for (int k = 0; k < 4; k++)
+                    error += cv::norm(label.apex[k] - objects[i].apex[k]);
+                *corner_error += error / 4;
+            }
+            break;
+        }
+    }
+    return matched;
+}
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_LABEL_SET_H
@@ -0,0 +1,152 @@
+/**
+ * @file NmsBench.cpp
+ * @brief 对比原有逐对 cv::Rect_ 比较的NMS与 NmsEngine 的耗时，并校验保留结果与角点投票一致
+ *
+ * 用法: NmsBench [iterations]
+ */
+#include "ArmorDetector/NmsEngine.hpp"
+#include "ArmorDetector/TopK.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace armor_detector;
+
+static constexpr float NMS_THRESH = 0.3;
+static constexpr float FFT_CONF_ERROR = 0.15;
+static constexpr float FFT_MIN_IOU = 0.9;
+static constexpr int IMG_W = 1280;
+static constexpr int IMG_H = 1024;
+
+/**
+ * @brief 原有的NMS流程（ArmorDetector 中的旧实现）
+ */
+static void legacyNms(std::vector<ArmorObject> &faceobjects, std::vector<int> &picked, float nms_threshold)
+{
+    picked.clear();
+
+    const int n = faceobjects.size();
+
+    for (int i = 0; i < n; i++)
+    {
+        ArmorObject &a = faceobjects[i];
+
+        int keep = 1;
+        for (int j = 0; j < (int)picked.size(); j++)
+        {
+            ArmorObject &b = faceobjects[picked[j]];
+
+            cv::Rect_<float> inter = a.rect & b.rect;
+            float inter_area = inter.area();
+            float union_area = a.rect.area() + b.rect.area() - inter_area;
+            float iou = inter_area / union_area;
+            if (iou > nms_threshold)
+            {
+                keep = 0;
+                if (iou > FFT_MIN_IOU && std::abs(a.prob - b.prob) < FFT_CONF_ERROR && a.cls == b.cls &&
+                    a.color == b.color)
+                {
+                    b.vote(a.apex);
+                }
+            }
+        }
+
+        if (keep)
+            picked.push_back(i);
+    }
+}
+
+/**
+ * @brief 生成聚集在若干目标附近的候选，模拟降低置信度阈值后的网络输出
+ */
+static std::vector<ArmorObject> makeProposals(int count, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> prob_dist(0.3f, 1.f);
+    std::uniform_real_distribution<float> center_dist(0.f, 1.f);
+    std::normal_distribution<float> jitter(0.f, 3.f);
+    std::uniform_int_distribution<int> size_dist(20, 160);
+    std::uniform_int_distribution<int> cls_dist(0, 1);
+
+    const int num_targets = std::max(1, count / 20);
+    std::vector<cv::Rect_<float>> targets;
+    for (int t = 0; t < num_targets; t++)
+    {
+        float w = size_dist(rng);
+        targets.emplace_back(center_dist(rng) * IMG_W, center_dist(rng) * IMG_H, w, w * 0.45f);
+    }
+
+    std::vector<ArmorObject> proposals(count);
+    for (int i = 0; i < count; i++)
+    {
+        const cv::Rect_<float> &target = targets[i % num_targets];
+        ArmorObject &obj = proposals[i];
+        float x = std::round(target.x + jitter(rng));
+        float y = std::round(target.y + jitter(rng));
+        obj.rect = cv::Rect_<float>(x, y, target.width, target.height);
+        obj.apex[0] = cv::Point2f(x, y);
+        obj.apex[1] = cv::Point2f(x, y + target.height);
+        obj.apex[2] = cv::Point2f(x + target.width, y + target.height);
+        obj.apex[3] = cv::Point2f(x + target.width, y);
+        for (int k = 0; k < 4; k++)
+            obj.vote_sum[k] = obj.apex[k];
+        obj.vote_count = 1;
+        obj.prob = prob_dist(rng);
+        obj.cls = cls_dist(rng);
+        obj.color = 0;
+    }
+    selectTopK(proposals, proposals.size());
+    return proposals;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+
+    std::mt19937 rng(606);
+    NmsEngine engine;
+    engine.setThreshold(NMS_THRESH);
+    engine.setVoting(FFT_MIN_IOU, FFT_CONF_ERROR);
+
+    bool all_match = true;
+    for (int count : {10, 128, 1000, 5000})
+    {
+        const std::vector<ArmorObject> source = makeProposals(count, rng);
+
+        std::vector<ArmorObject> legacy_work, engine_work;
+        std::vector<int> legacy_picked, engine_picked;
+        double legacy_ms = 0, engine_ms = 0;
+        for (int it = 0; it < iterations; it++)
+        {
+            legacy_work = source;
+            auto t1 = std::chrono::steady_clock::now();
+            legacyNms(legacy_work, legacy_picked, NMS_THRESH);
+            auto t2 = std::chrono::steady_clock::now();
+            legacy_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+            engine_work = source;
+            t1 = std::chrono::steady_clock::now();
+            engine.run(engine_work, engine_picked, IMG_W, IMG_H);
+            t2 = std::chrono::steady_clock::now();
+            engine_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+
+        bool match = legacy_picked == engine_picked;
+        for (size_t i = 0; match && i < legacy_picked.size(); i++)
+        {
+            const ArmorObject &a = legacy_work[legacy_picked[i]];
+            const ArmorObject &b = engine_work[engine_picked[i]];
+            match = a.vote_count == b.vote_count;
+            for (int k = 0; match && k < 4; k++)
+                match = a.vote_sum[k].x == b.vote_sum[k].x && a.vote_sum[k].y == b.vote_sum[k].y;
+        }
+        all_match = all_match && match;
+
+        cout << count << " proposals, " << legacy_picked.size() << " kept: legacy " << legacy_ms * 1000 / iterations
+             << " us, engine " << engine_ms * 1000 / iterations << " us" << (match ? "" : "  MISMATCH") << endl;
+    }
+
+    return all_match ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file PrecisionBench.cpp
+ * @brief 在标注图像集上对比各推理精度的单帧耗时、召回率与角点误差
+ *
+ * 用法: PrecisionBench <model.xml> <detector.xml> <image dir> [precision ...]
+ * 默认对比 FP32、BF16 与 INT8，INT8 使用识别器配置中 INT8_MODEL 指定的量化模型，未配置时跳过。
+ * 标注格式见 LabelSet.hpp；无标注时以第一个成功加载的精度的识别结果为参考。
+ * 识别器配置应关闭 ROI_MODE，保证每张图像都在全图上推理。
+ */
+#include "ArmorDetector/ArmorDetector.hpp"
+#include "LabelSet.hpp"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace armor_detector;
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        cout << "Usage: " << argv[0] << " <model.xml> <detector.xml> <image dir> [precision ...]" << endl;
+        return 1;
+    }
+
+    std::vector<std::string> precisions(argv + 4, argv + argc);
+    if (precisions.empty())
+        precisions = {"FP32", "BF16", "INT8"};
+
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<ArmorLabel>> labels;
+    bool labeled = readImageSet(argv[3], images, labels);
+    if (images.empty())
+    {
+        cout << " ERROR: " << argv[3] << " 中没有图像" << endl;
+        return 1;
+    }
+    cout << images.size() << " images, reference: " << (labeled ? "labels" : "the first precision") << endl;
+
+    std::vector<ArmorObject> objects;
+    bool has_reference = labeled;
+    for (const auto &precision : precisions)
+    {
+        ArmorDetector detector;
+        detector.readConfig(argv[2]);
+        detector.setInferencePrecision(precision);
+        if (!detector.initModel(argv[1]))
+            continue;
+        detector.warmup(images[0].size());
+
+        double total_ms = 0, corner_error = 0;
+        int total_ref = 0, total_matched = 0;
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            auto t1 = std::chrono::steady_clock::now();
+            detector.detect(images[i], objects);
+            auto t2 = std::chrono::steady_clock::now();
+            total_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+            if (!has_reference)
+                appendReference(objects, labels[i]);
+
+            total_ref += labels[i].size();
+            total_matched += countMatched(labels[i], objects, &corner_error);
+        }
+        has_reference = true;
+
+        cout << precision << ": " << total_ms / images.size() << " ms/frame, recall "
+             << (total_ref > 0 ? 100.0 * total_matched / total_ref : 0.0) << "% (" << total_matched << "/"
+             << total_ref << "), corner error " << (total_matched > 0 ? corner_error / total_matched : 0.0) << " px"
+             << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file PreprocessBench.cpp
+ * @brief 对比原有 scaledResize + convertTo + split + memcpy 预处理与融合 LetterboxKernel 的耗时
+ *
+ * 用法: PreprocessBench [image] [iterations]
+ * 不指定图像时使用随机生成的 1280x1024 BGR 图像
+ */
+#include "ArmorDetector/Preprocess.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+static constexpr int INPUT_W = 416;
+static constexpr int INPUT_H = 416;
+
+/**
+ * @brief 原有的预处理流程（ArmorDetector::detect 中的旧实现）
+ */
+static void legacyPreprocess(Mat &img, float *blob_data, Eigen::Matrix<float, 3, 3> &transform_matrix)
+{
+    float r = std::min(INPUT_W / (img.cols * 1.0), INPUT_H / (img.rows * 1.0));
+    int unpad_w = r * img.cols;
+    int unpad_h = r * img.rows;
+
+    int dw = INPUT_W - unpad_w;
+    int dh = INPUT_H - unpad_h;
+
+    dw /= 2;
+    dh /= 2;
+
+    transform_matrix << 1.0 / r, 0, -dw / r, 0, 1.0 / r, -dh / r, 0, 0, 1;
+
+    Mat re;
+    cv::resize(img, re, Size(unpad_w, unpad_h));
+    Mat pr_img;
+    cv::copyMakeBorder(re, pr_img, dh, dh, dw, dw, BORDER_CONSTANT);
+
+    cv::Mat pre;
+    cv::Mat pre_split[3];
+    pr_img.convertTo(pre, CV_32F);
+    cv::split(pre, pre_split);
+
+    for (int c = 0; c < 3; c++)
+    {
+        memcpy(blob_data, pre_split[c].data, INPUT_W * INPUT_H * sizeof(float));
+        blob_data += INPUT_W * INPUT_H;
+    }
+}
+
+template <typename F> static double timeIt(int iterations, F &&f)
+{
+    f(); // warm up
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t2 - t1).count() / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    Mat src;
+    if (argc > 1)
+        src = imread(argv[1]);
+    if (src.empty())
+    {
+        src.create(1024, 1280, CV_8UC3);
+        randu(src, Scalar::all(0), Scalar::all(255));
+    }
+    int iterations = argc > 2 ? atoi(argv[2]) : 500;
+
+    std::vector<float> legacy_blob(3 * INPUT_W * INPUT_H);
+    std::vector<float> fused_blob(3 * INPUT_W * INPUT_H);
+    Eigen::Matrix<float, 3, 3> legacy_matrix;
+    Eigen::Matrix<float, 3, 3> fused_matrix;
+    armor_detector::LetterboxKernel letterbox;
+
+    double legacy_ms = timeIt(iterations, [&] { legacyPreprocess(src, legacy_blob.data(), legacy_matrix); });
+    double fused_ms =
+        timeIt(iterations, [&] { letterbox.run(src, fused_blob.data(), INPUT_W, INPUT_H, fused_matrix); });
+
+    float max_diff = 0.f;
+    for (size_t i = 0; i < legacy_blob.size(); i++)
+        max_diff = std::max(max_diff, std::abs(legacy_blob[i] - fused_blob[i]));
+
+    cout << "input: " << src.cols << "x" << src.rows << " -> " << INPUT_W << "x" << INPUT_H << ", " << iterations
+         << " iterations" << endl;
+    cout << "legacy : " << legacy_ms << " ms/frame" << endl;
+    cout << "fused  : " << fused_ms << " ms/frame (x" << legacy_ms / fused_ms << ")" << endl;
+    cout << "max abs diff: " << max_diff << ", transform diff: " << (legacy_matrix - fused_matrix).norm() << endl;
+
+    return 0;
+}
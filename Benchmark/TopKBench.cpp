@@ -0,0 +1,110 @@
+/**
+ * @file TopKBench.cpp
+ * @brief 对比原有递归OpenMP快速排序 + 截断 与 selectTopK 的候选排序耗时
+ *
+ * 用法: TopKBench [iterations]
+ */
+#include "ArmorDetector/ArmorDetector.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace armor_detector;
+
+static constexpr int TOPK = 128;
+
+static void qsort_descent_inplace(std::vector<ArmorObject> &faceobjects, int left, int right)
+{
+    int i = left;
+    int j = right;
+    float p = faceobjects[(left + right) / 2].prob;
+
+    while (i <= j)
+    {
+        while (faceobjects[i].prob > p)
+            i++;
+
+        while (faceobjects[j].prob < p)
+            j--;
+
+        if (i <= j)
+        {
+            std::swap(faceobjects[i], faceobjects[j]);
+
+            i++;
+            j--;
+        }
+    }
+
+#pragma omp parallel sections
+    {
+#pragma omp section
+        {
+            if (left < j)
+                qsort_descent_inplace(faceobjects, left, j);
+        }
+#pragma omp section
+        {
+            if (i < right)
+                qsort_descent_inplace(faceobjects, i, right);
+        }
+    }
+}
+
+/**
+ * @brief 原有的排序与截断流程
+ */
+static void legacyTopK(std::vector<ArmorObject> &objects)
+{
+    if (!objects.empty())
+        qsort_descent_inplace(objects, 0, objects.size() - 1);
+
+    if (objects.size() >= TOPK)
+        objects.resize(TOPK);
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+
+    std::mt19937 rng(606);
+    std::uniform_real_distribution<float> prob_dist(0.6f, 1.f);
+    std::uniform_real_distribution<float> pos_dist(0.f, 1200.f);
+
+    for (int count : {0, 10, 100, 1000})
+    {
+        std::vector<ArmorObject> source(count);
+        for (auto &obj : source)
+        {
+            obj.prob = prob_dist(rng);
+            obj.rect = cv::Rect_<float>(pos_dist(rng), pos_dist(rng), 40, 20);
+            for (int i = 0; i < 4; i++)
+                obj.apex[i] = obj.rect.tl();
+        }
+
+        std::vector<ArmorObject> work;
+        work.reserve(count);
+        double legacy_ms = 0, topk_ms = 0;
+        for (int it = 0; it < iterations; it++)
+        {
+            work.assign(source.begin(), source.end());
+            auto t1 = std::chrono::steady_clock::now();
+            legacyTopK(work);
+            auto t2 = std::chrono::steady_clock::now();
+            legacy_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+            work.assign(source.begin(), source.end());
+            t1 = std::chrono::steady_clock::now();
+            selectTopK(work, TOPK);
+            t2 = std::chrono::steady_clock::now();
+            topk_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+
+        cout << count << " proposals: legacy " << legacy_ms * 1000 / iterations << " us, topk "
+             << topk_ms * 1000 / iterations << " us" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "FrameMailbox.hpp"
+
+namespace mindvision
+{
+
+void FrameMailbox::publish(const cv::Mat &frame, std::chrono::steady_clock::time_point ready_time)
+{
+    slots[back] = frame;
+    ready_times[back] = ready_time;
+    int prev = middle.load();
+    while (!middle.compare_exchange_weak(prev, back | FRESH | (prev & CLOSED)))
+        ;
+    back = prev & INDEX_MASK;
+    if (prev & FRESH)
+    {
+        // 上一帧未被取走，立即释放以归还缓冲区
+        dropped_frames++;
+        slots[back].release();
+    }
+    middle.notify_one();
+}
+
+bool FrameMailbox::take(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time)
+{
+    int prev = middle.load();
+    if (!(prev & FRESH))
+        return false;
+
+    // 只有消费者会清除新帧标记，交换时保留关闭标记
+    while (!middle.compare_exchange_weak(prev, front | (prev & CLOSED)))
+        ;
+    front = prev & INDEX_MASK;
+    frame = std::move(slots[front]);
+    if (ready_time)
+        *ready_time = ready_times[front];
+
+    // 唤醒等待新帧被取走的生产者
+    middle.notify_one();
+    return true;
+}
+
+bool FrameMailbox::wait(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time)
+{
+    int state = middle.load();
+    while (!(state & FRESH))
+    {
+        if (state & CLOSED)
+            return false;
+        middle.wait(state);
+        state = middle.load();
+    }
+    return take(frame, ready_time);
+}
+
+bool FrameMailbox::waitTaken()
+{
+    int state = middle.load();
+    while ((state & FRESH) && !(state & CLOSED))
+    {
+        middle.wait(state);
+        state = middle.load();
+    }
+    return !(state & CLOSED);
+}
+
+void FrameMailbox::close()
+{
+    middle.fetch_or(CLOSED);
+    middle.notify_all();
+}
+
+void FrameMailbox::open()
+{
+    middle.fetch_and(~CLOSED);
+}
+
+int64_t FrameMailbox::dropped() const
+{
+    return dropped_frames.load();
+}
+
+} // namespace mindvision
@@ -0,0 +1,75 @@
+#ifndef FRAME_MAILBOX_HPP
+#define FRAME_MAILBOX_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <opencv2/core/core.hpp>
+
+namespace mindvision
+{
+
+/**
+ * @brief 单生产者单消费者的最新帧邮箱（三缓冲，无锁）
+ *
+ * 采集线程与消费线程各持有一个槽位，第三个槽位通过原子交换在两者之间传递。消费者总是取到最新一帧，
+ * 未被取走就被新帧覆盖的帧计为丢帧；被覆盖的帧立即释放，缓冲区归还缓冲池。
+ */
+class FrameMailbox
+{
+  public:
+    /**
+     * @brief Publish a frame, called by the producer only.
+     * @param ready_time When the camera delivered the frame, handed to the consumer with it.
+     */
+    void publish(const cv::Mat &frame, std::chrono::steady_clock::time_point ready_time = {});
+
+    /**
+     * @brief Take the newest frame if one arrived since the last take, called by the consumer only.
+     * @return False if there is no new frame.
+     */
+    bool take(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time = nullptr);
+
+    /**
+     * @brief Block until a new frame arrives or the mailbox is closed.
+     * @return False if the mailbox is closed.
+     */
+    bool wait(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time = nullptr);
+
+    /**
+     * @brief Block the producer until the consumer took the last published frame, for sources that must not drop.
+     * @return False if the mailbox is closed.
+     */
+    bool waitTaken();
+
+    /**
+     * @brief Wake both sides and make wait() and waitTaken() return false, e.g. when the camera stops.
+     */
+    void close();
+
+    /**
+     * @brief Reopen after close(), only while neither side is using the mailbox.
+     */
+    void open();
+
+    /**
+     * @brief Frames overwritten before the consumer took them.
+     */
+    int64_t dropped() const;
+
+  private:
+    static constexpr int INDEX_MASK = 0x3;
+    static constexpr int FRESH = 0x4;  // 中间槽位是尚未取走的新帧
+    static constexpr int CLOSED = 0x8; // 已关闭
+
+    cv::Mat slots[3];                                     // 三个槽位
+    std::chrono::steady_clock::time_point ready_times[3]; // 各槽位帧的就绪时间
+    std::atomic<int> middle{1};                           // 中间槽位下标与状态位
+    int back = 0;                                         // 生产者槽位（仅生产者访问）
+    int front = 2;                                        // 消费者槽位（仅消费者访问）
+    std::atomic<int64_t> dropped_frames{0};               // 丢帧数
+};
+
+} // namespace mindvision
+
+#endif
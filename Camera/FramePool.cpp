@@ -0,0 +1,115 @@
+#include "FramePool.hpp"
+#include <iostream>
+
+namespace mindvision
+{
+// 池外分配的缓冲区在 allocatorFlags_ 中记为 -1，其余记录缓冲区下标
+static constexpr int HEAP_BUFFER = -1;
+
+FramePool::~FramePool()
+{
+    release();
+}
+
+void FramePool::release()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_ids.size() != buffers.size())
+        std::cout << "Warning, " << buffers.size() - free_ids.size() << " frames still in use" << std::endl;
+    for (auto buffer : buffers)
+        cv::fastFree(buffer);
+    buffers.clear();
+    free_ids.clear();
+}
+
+void FramePool::reset(int count, size_t _buffer_size)
+{
+    release();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer_size = _buffer_size;
+    for (int i = 0; i < count; i++)
+    {
+        buffers.push_back(static_cast<uchar *>(cv::fastMalloc(buffer_size)));
+        free_ids.push_back(i);
+    }
+}
+
+cv::Mat FramePool::acquire(int rows, int cols, int type)
+{
+    cv::Mat frame;
+    frame.allocator = this;
+    frame.create(rows, cols, type);
+    return frame;
+}
+
+int64_t FramePool::misses() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
+
+cv::UMatData *FramePool::allocate(int dims, const int *sizes, int type, void *data, size_t *step, cv::AccessFlag,
+                                  cv::UMatUsageFlags) const
+{
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--)
+    {
+        if (step)
+            step[i] = total;
+        total *= sizes[i];
+    }
+
+    cv::UMatData *u = new cv::UMatData(this);
+    u->size = total;
+    if (data)
+    {
+        // 外部数据不经过池
+        u->data = u->origdata = static_cast<uchar *>(data);
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+        return u;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!free_ids.empty() && total <= buffer_size)
+    {
+        u->allocatorFlags_ = free_ids.back();
+        u->data = u->origdata = buffers[free_ids.back()];
+        free_ids.pop_back();
+    }
+    else
+    {
+        // 缓冲区用尽（下游持有过多帧）或尺寸超出时临时分配
+        u->allocatorFlags_ = HEAP_BUFFER;
+        u->data = u->origdata = static_cast<uchar *>(cv::fastMalloc(total));
+        miss_count++;
+    }
+    return u;
+}
+
+bool FramePool::allocate(cv::UMatData *u, cv::AccessFlag, cv::UMatUsageFlags) const
+{
+    return u != nullptr;
+}
+
+void FramePool::deallocate(cv::UMatData *u) const
+{
+    if (!u)
+        return;
+
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED))
+    {
+        if (u->allocatorFlags_ == HEAP_BUFFER)
+        {
+            cv::fastFree(u->origdata);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            free_ids.push_back(u->allocatorFlags_);
+        }
+    }
+    delete u;
+}
+
+} // namespace mindvision
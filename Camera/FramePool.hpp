@@ -0,0 +1,58 @@
+#ifndef FRAME_POOL_HPP
+#define FRAME_POOL_HPP
+
+#include <mutex>
+#include <opencv2/core/core.hpp>
+#include <vector>
+
+namespace mindvision
+{
+
+/**
+ * @brief 预分配的图像缓冲池
+ *
+ * 作为 cv::MatAllocator 使用：以 mat.allocator = &pool 后 create() 得到的图像直接占用池中的一块缓冲区，
+ * ISP 可直接写入；图像按 cv::Mat 引用计数共享，最后一个引用释放时缓冲区自动归还。
+ * 缓冲区用尽时临时从堆上分配，不阻塞采集。池须在所有图像释放后再析构。
+ */
+class FramePool : public cv::MatAllocator
+{
+  public:
+    FramePool() = default;
+    ~FramePool() override;
+
+    /**
+     * @brief Preallocate the buffers, only call it while no frame is in use.
+     * @param count Number of buffers, at least the number of frames held at once plus one.
+     * @param buffer_size Bytes of each buffer, the largest frame the camera can produce.
+     */
+    void reset(int count, size_t buffer_size);
+
+    /**
+     * @brief Create a frame in a free buffer.
+     */
+    cv::Mat acquire(int rows, int cols, int type);
+
+    /**
+     * @brief Number of frames that had to be allocated outside the pool.
+     */
+    int64_t misses() const;
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usage_flags) const override;
+    bool allocate(cv::UMatData *data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override;
+    void deallocate(cv::UMatData *data) const override;
+
+  private:
+    void release();
+
+    mutable std::mutex mutex;          // 保护空闲列表（图像可能在其他线程释放）
+    std::vector<uchar *> buffers;      // 预分配的缓冲区
+    mutable std::vector<int> free_ids; // 空闲缓冲区下标
+    size_t buffer_size = 0;            // 每块缓冲区字节数
+    mutable int64_t miss_count = 0;    // 池外分配次数
+};
+
+} // namespace mindvision
+
+#endif
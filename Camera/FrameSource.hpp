@@ -0,0 +1,48 @@
+#ifndef FRAME_SOURCE_HPP
+#define FRAME_SOURCE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <opencv2/core/core.hpp>
+#include <string>
+
+/**
+ * @brief 图像源接口：工业相机与录像回放使用同一套采集接口
+ *
+ * startCapture() 后由图像源自己的线程（或SDK回调）持续产生图像，latestFrame() 只取最新一帧。
+ * 识别、解算与通信流程只依赖本接口，没有相机时可用录像回放进行测试与压测。
+ */
+class FrameSource
+{
+  public:
+    virtual ~FrameSource() = default;
+
+    // 启动采集
+    virtual bool startCapture() = 0;
+
+    // 停止采集，latestFrame() 随之返回false
+    virtual void stopCapture() = 0;
+
+    // 取最新一帧，没有新帧时等待；ready_time 返回该帧就绪的时间；采集停止或图像源结束后返回false
+    virtual bool latestFrame(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time = nullptr) = 0;
+
+    // 未被取走就被新帧覆盖的帧数
+    virtual int64_t droppedFrames() const = 0;
+
+    // 图像尺寸
+    virtual cv::Size frameSize() const = 0;
+
+    // 输出拜耳原始图像时左上2x2单元的颜色排列（如"BGGR"），否则为空
+    virtual std::string bayerPattern() const
+    {
+        return std::string();
+    }
+
+    // 白平衡增益（B G R），输出拜耳原始图像时由识别器应用
+    virtual cv::Scalar whiteBalance()
+    {
+        return cv::Scalar(1, 1, 1);
+    }
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "IspWorkerPool.hpp"
+#include <cstring>
+
+namespace mindvision
+{
+
+IspWorkerPool::~IspWorkerPool()
+{
+    stop();
+}
+
+void IspWorkerPool::start(int workers, size_t raw_size, Process _process, FrameMailbox *_output)
+{
+    if (!threads.empty() || workers <= 0)
+        return;
+
+    // 每个工作线程最多处理一帧、排队一帧，结果槽位与原始缓冲区按此上限分配
+    const int outstanding = workers * 2 + 1;
+    raw_pool.reset(outstanding, raw_size);
+    reorder.assign(outstanding, Finished());
+    process = std::move(_process);
+    output = _output;
+    max_queued = workers;
+    next_seq = 0;
+    publish_seq = 0;
+
+    running = true;
+    for (int i = 0; i < workers; i++)
+        threads.emplace_back(&IspWorkerPool::workerLoop, this);
+}
+
+void IspWorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        running = false;
+        jobs.clear();
+    }
+    job_cv.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+    threads.clear();
+
+    // 未发布的帧占用缓冲池，停止时一并释放
+    std::lock_guard<std::mutex> lock(order_mutex);
+    for (auto &finished : reorder)
+        finished = Finished();
+}
+
+void IspWorkerPool::submit(const BYTE *raw, const tSdkFrameHead &head,
+                           std::chrono::steady_clock::time_point ready_time)
+{
+    {
+        // 最早的一帧迟迟未完成时后续结果无处存放，直接丢弃新帧
+        std::lock_guard<std::mutex> lock(order_mutex);
+        if (next_seq - publish_seq >= (int64_t)reorder.size())
+        {
+            dropped_jobs++;
+            return;
+        }
+    }
+
+    Job job;
+    job.raw = raw_pool.acquire(1, head.uBytes, CV_8UC1);
+    std::memcpy(job.raw.data, raw, head.uBytes);
+    job.head = head;
+    job.ready_time = ready_time;
+
+    int64_t stale = -1;
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        if (!running)
+            return;
+        job.seq = next_seq++;
+        jobs.push_back(std::move(job));
+
+        // 工作线程都在忙时丢弃最早排队的一帧，原始缓冲区随之归还
+        if ((int)jobs.size() > max_queued)
+        {
+            stale = jobs.front().seq;
+            jobs.pop_front();
+            dropped_jobs++;
+        }
+    }
+    job_cv.notify_one();
+
+    if (stale >= 0)
+        finish(stale, cv::Mat(), {});
+}
+
+int64_t IspWorkerPool::dropped() const
+{
+    return dropped_jobs.load();
+}
+
+void IspWorkerPool::workerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_cv.wait(lock, [this] { return !running || !jobs.empty(); });
+            if (!running)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        cv::Mat frame;
+        process(job.raw.data, &job.head, frame);
+        job.raw.release();
+        finish(job.seq, std::move(frame), job.ready_time);
+    }
+}
+
+/**
+ * @brief Store the result of a frame and publish every frame that is now complete in capture order.
+ * @param seq Capture sequence number of the frame.
+ * @param frame Processed frame, empty if the frame was discarded.
+ * @param ready_time When the SDK delivered the frame.
+ */
+void IspWorkerPool::finish(int64_t seq, cv::Mat frame, std::chrono::steady_clock::time_point ready_time)
+{
+    std::lock_guard<std::mutex> lock(order_mutex);
+    Finished &finished = reorder[seq % reorder.size()];
+    finished.done = true;
+    finished.frame = std::move(frame);
+    finished.ready_time = ready_time;
+
+    while (true)
+    {
+        Finished &next = reorder[publish_seq % reorder.size()];
+        if (!next.done)
+            break;
+        if (!next.frame.empty())
+            output->publish(next.frame, next.ready_time);
+        next = Finished();
+        publish_seq++;
+    }
+}
+
+} // namespace mindvision
@@ -0,0 +1,101 @@
+#ifndef ISP_WORKER_POOL_HPP
+#define ISP_WORKER_POOL_HPP
+
+#include "CameraApi.h"
+#include "FrameMailbox.hpp"
+#include "FramePool.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <opencv2/core/core.hpp>
+#include <thread>
+#include <vector>
+
+namespace mindvision
+{
+
+/**
+ * @brief 并行ISP：多个工作线程同时处理相邻帧，按采集顺序输出
+ *
+ * 原始数据复制到预分配的缓冲区后SDK缓冲区即可归还，采集线程（或SDK回调）不等待ISP。
+ * 工作线程处理完成的帧经重排序后依次发布到邮箱，发布在锁内进行，邮箱仍只有一个逻辑上的生产者。
+ * 等待处理的帧超过工作线程数时丢弃最早的一帧，保证采集不被阻塞。
+ * SDK未说明同一相机句柄的ISP可并发调用，MVCamera 只使用一个工作线程，仅把ISP移出采集线程。
+ */
+class IspWorkerPool
+{
+  public:
+    // 处理一帧原始数据，输出写入缓冲池
+    using Process = std::function<void(BYTE *raw, tSdkFrameHead *head, cv::Mat &frame)>;
+
+    ~IspWorkerPool();
+
+    /**
+     * @brief Start the worker threads.
+     * @param workers Number of worker threads.
+     * @param raw_size Bytes of the largest raw frame the camera can produce.
+     * @param process ISP of one frame, called concurrently from the worker threads.
+     * @param output Mailbox the processed frames are published to in capture order.
+     */
+    void start(int workers, size_t raw_size, Process process, FrameMailbox *output);
+
+    /**
+     * @brief Stop and join the worker threads, frames not yet processed are discarded.
+     */
+    void stop();
+
+    /**
+     * @brief Copy a raw frame and queue it, the SDK buffer can be released as soon as this returns.
+     */
+    void submit(const BYTE *raw, const tSdkFrameHead &head, std::chrono::steady_clock::time_point ready_time);
+
+    /**
+     * @brief Raw frames discarded because every worker was busy.
+     */
+    int64_t dropped() const;
+
+  private:
+    // 等待处理的原始帧
+    struct Job
+    {
+        int64_t seq = 0;                                  // 采集序号
+        cv::Mat raw;                                      // 原始数据（占用原始缓冲池中的一块）
+        tSdkFrameHead head;                               // 帧头
+        std::chrono::steady_clock::time_point ready_time; // SDK交付该帧的时间
+    };
+
+    // 重排序槽位
+    struct Finished
+    {
+        bool done = false;                                // 已处理或已丢弃
+        cv::Mat frame;                                    // 处理后的图像，丢弃时为空
+        std::chrono::steady_clock::time_point ready_time; // SDK交付该帧的时间
+    };
+
+    void workerLoop();
+    void finish(int64_t seq, cv::Mat frame, std::chrono::steady_clock::time_point ready_time);
+
+    FramePool raw_pool;               // 原始数据缓冲池
+    Process process;                  // ISP
+    FrameMailbox *output = nullptr;   // 输出邮箱
+    std::vector<std::thread> threads; // 工作线程
+    int max_queued = 0;               // 等待处理的最大帧数
+
+    std::mutex job_mutex;           // 保护任务队列
+    std::condition_variable job_cv; // 新任务通知
+    std::deque<Job> jobs;           // 任务队列
+    bool running = false;           // 工作线程运行中
+    int64_t next_seq = 0;           // 下一帧的采集序号
+
+    std::mutex order_mutex;               // 保护重排序状态与邮箱发布
+    std::vector<Finished> reorder;        // 按序号取模存放的处理结果
+    int64_t publish_seq = 0;              // 下一帧应发布的序号
+    std::atomic<int64_t> dropped_jobs{0}; // 丢弃的原始帧数
+};
+
+} // namespace mindvision
+
+#endif
@@ -1,5 +1,6 @@
 #include "MVCamera.hpp"
 #include <iostream>
+#include <cstring>
 #include <opencv2/opencv.hpp>
 #include <stdio.h>
 using namespace std;
@@ -10,6 +11,18 @@ MVCamera::MVCamera(const CameraParam &_camera_param)
 {
     if (_camera_param.camera_mode == 0)
     {
+        frame_pool_size = _camera_param.frame_pool_size;
+        acquisition = _camera_param.acquisition;
+        raw_bayer = _camera_param.raw_bayer;
+        isp_workers = _camera_param.isp_workers;
+        // SDK未说明同一相机句柄的ISP可并发调用，只用一个工作线程把ISP移出采集线程
+        if (isp_workers > 1)
+        {
+            std::cout << "Warning, isp_workers " << isp_workers
+                      << " clamped to 1, mindvision ISP of one camera runs on a single thread" << std::endl;
+            isp_workers = 1;
+        }
+        frame_size = cv::Size(_camera_param.resolution.cols, _camera_param.resolution.rows);
         cameraInit(_camera_param.resolution.cols, _camera_param.resolution.rows, _camera_param.camera_exposuretime);
 
         iscamera0_open = true;
@@ -28,11 +41,11 @@ MVCamera::MVCamera(const CameraParam &_camera_param)
 
 MVCamera::~MVCamera()
 {
+    stopCapture();
     if (iscamera0_open)
     {
 
         CameraUnInit(hCamera);
-        free(g_pRgbBuffer);
     }
 }
 // 相机初始化
@@ -66,8 +79,9 @@ int MVCamera::cameraInit(const int _CAMERA_RESOLUTION_COLS, const int _CAMERA_RE
     std::cout << "Info, Init mindvision industrial camera success:" << std::endl;
     CameraGetCapability(hCamera, &tCapability);
 
-    g_pRgbBuffer = static_cast<unsigned char *>(
-        malloc(tCapability.sResolutionRange.iHeightMax * tCapability.sResolutionRange.iWidthMax * 3));
+    // ISP直接写入缓冲池，按最大分辨率的BGR图像分配
+    frame_pool.reset(frame_pool_size,
+                     (size_t)tCapability.sResolutionRange.iHeightMax * tCapability.sResolutionRange.iWidthMax * 3);
 
     // 设置相机分辨率
     CameraGetImageResolution(hCamera, &pImageResolution);
@@ -104,9 +118,46 @@ int MVCamera::cameraInit(const int _CAMERA_RESOLUTION_COLS, const int _CAMERA_RE
         CameraSetIspOutFormat(hCamera, CAMERA_MEDIA_TYPE_BGR8);
     }
 
+    if (raw_bayer)
+        selectRawFormat();
+
     return 1;
 }
 
+// 选择8位拜耳输出格式
+void MVCamera::selectRawFormat()
+{
+    static const struct
+    {
+        UINT media_type;
+        const char *pattern;
+    } formats[] = {
+        {CAMERA_MEDIA_TYPE_BAYBG8, "BGGR"},
+        {CAMERA_MEDIA_TYPE_BAYGB8, "GBRG"},
+        {CAMERA_MEDIA_TYPE_BAYGR8, "GRBG"},
+        {CAMERA_MEDIA_TYPE_BAYRG8, "RGGB"},
+    };
+
+    if (!tCapability.sIspCapacity.bMonoSensor)
+    {
+        for (int i = 0; i < tCapability.iMediaTypdeDesc; i++)
+        {
+            for (const auto &format : formats)
+            {
+                if (tCapability.pMediaTypeDesc[i].iMediaType != format.media_type ||
+                    CameraSetMediaType(hCamera, i) != CAMERA_STATUS_SUCCESS)
+                    continue;
+                bayer_pattern = format.pattern;
+                std::cout << "Info, mindvision raw bayer output: " << bayer_pattern << std::endl;
+                return;
+            }
+        }
+    }
+
+    raw_bayer = false;
+    std::cout << "Error, mindvision camera has no 8-bit bayer output, fall back to ISP output" << std::endl;
+}
+
 // 相机是否在线
 bool MVCamera::isCameraOnline()
 {
@@ -115,28 +166,191 @@ bool MVCamera::isCameraOnline()
 
     if (iscamera0_open == 1)
     {
-        if (CameraGetImageBuffer(hCamera, &sFrameInfo, &pbyBuffer, 1000) == CAMERA_STATUS_SUCCESS)
+        grabFrame();
+
+        isindustry_camera_open = true;
+    }
+    else
+    {
+        isindustry_camera_open = false;
+    }
+
+    return isindustry_camera_open;
+}
+
+// 采集并处理一帧
+bool MVCamera::grabFrame()
+{
+    if (CameraGetImageBuffer(hCamera, &sFrameInfo, &pbyBuffer, 1000) != CAMERA_STATUS_SUCCESS)
+        return false;
+    frame_ready = std::chrono::steady_clock::now();
+
+    // 先释放上一帧的引用，下游仍持有时缓冲区不会被覆盖
+    frame.release();
+    processFrame(pbyBuffer, &sFrameInfo, frame);
+    return true;
+}
+
+// 处理一帧写入缓冲池
+void MVCamera::processFrame(BYTE *_pFrameBuffer, tSdkFrameHead *_pFrameHead, cv::Mat &_frame)
+{
+    if (raw_bayer)
+    {
+        // 跳过ISP，原始数据复制出来后SDK缓冲区即可归还
+        _frame = frame_pool.acquire(_pFrameHead->iHeight, _pFrameHead->iWidth, CV_8UC1);
+        std::memcpy(_frame.data, _pFrameBuffer, (size_t)_pFrameHead->iHeight * _pFrameHead->iWidth);
+        return;
+    }
+
+    _frame = frame_pool.acquire(_pFrameHead->iHeight, _pFrameHead->iWidth, CV_8UC(channel));
+    CameraImageProcess(hCamera, _pFrameBuffer, _frame.data, _pFrameHead);
+}
+
+// 启动采集
+bool MVCamera::startCapture()
+{
+    if (!iscamera0_open)
+    {
+        mailbox.close();
+        return false;
+    }
+    if (capturing)
+        return true;
+
+    mailbox.open();
+    capturing = true;
+
+    // 拜耳原始图像只需复制，不经过ISP
+    offthread_isp = isp_workers > 0 && !raw_bayer;
+    if (offthread_isp)
+    {
+        const size_t raw_size =
+            (size_t)tCapability.sResolutionRange.iHeightMax * tCapability.sResolutionRange.iWidthMax * 2;
+        isp_pool.start(
+            isp_workers, raw_size,
+            [this](BYTE *raw, tSdkFrameHead *head, cv::Mat &processed) { processFrame(raw, head, processed); },
+            &mailbox);
+    }
+
+    // 回调方式下SDK在帧就绪时直接调用，省去轮询等待；注册失败时回退到采集线程轮询
+    if (acquisition == ACQUISITION_CALLBACK)
+    {
+        iStatus = CameraSetCallbackFunction(hCamera, &MVCamera::frameCallback, this, nullptr);
+        if (iStatus == CAMERA_STATUS_SUCCESS)
         {
-            CameraImageProcess(hCamera, pbyBuffer, g_pRgbBuffer, &sFrameInfo);
+            callback_registered = true;
+            std::cout << "Info, mindvision frame callback registered" << std::endl;
+            return true;
+        }
+        std::cout << "Error, register mindvision frame callback failed: " << iStatus << ", fall back to polling"
+                  << std::endl;
+    }
 
-            if (iplImage)
-            {
-                cvReleaseImageHeader(&iplImage);
-            }
+    capture_thread = std::thread(&MVCamera::captureLoop, this);
+    return true;
+}
+
+// 停止采集
+void MVCamera::stopCapture()
+{
+    capturing = false;
+    if (callback_registered)
+    {
+        CameraSetCallbackFunction(hCamera, nullptr, nullptr, nullptr);
+        callback_registered = false;
+
+        // 等待注销前已进入的回调返回，之后不会再访问本对象
+        std::lock_guard<std::mutex> lock(callback_mutex);
+    }
+    if (capture_thread.joinable())
+        capture_thread.join();
 
-            iplImage = cvCreateImageHeader(cvSize(sFrameInfo.iWidth, sFrameInfo.iHeight), IPL_DEPTH_8U, channel);
+    // 生产者全部停止后再关闭邮箱
+    isp_pool.stop();
+    mailbox.close();
+}
 
-            cvSetData(iplImage, g_pRgbBuffer, sFrameInfo.iWidth * channel);
+// 采集线程：处理完成后立即归还SDK缓冲区，与推理并行
+void MVCamera::captureLoop()
+{
+    while (capturing)
+    {
+        if (offthread_isp)
+        {
+            // 原始数据复制后立即归还SDK缓冲区，ISP在工作线程中进行
+            if (CameraGetImageBuffer(hCamera, &sFrameInfo, &pbyBuffer, 1000) != CAMERA_STATUS_SUCCESS)
+                continue;
+            isp_pool.submit(pbyBuffer, sFrameInfo, std::chrono::steady_clock::now());
+            CameraReleaseImageBuffer(hCamera, pbyBuffer);
+            continue;
         }
 
-        isindustry_camera_open = true;
+        if (!grabFrame())
+            continue;
+        CameraReleaseImageBuffer(hCamera, pbyBuffer);
+        mailbox.publish(frame, frame_ready);
+        frame.release();
     }
-    else
+}
+
+// SDK帧回调
+void MVCamera::frameCallback(CameraHandle, BYTE *_pFrameBuffer, tSdkFrameHead *_pFrameHead, PVOID _pContext)
+{
+    static_cast<MVCamera *>(_pContext)->onFrame(_pFrameBuffer, _pFrameHead);
+}
+
+// 回调中处理一帧：原始缓冲区由SDK在回调返回后回收，不能调用 CameraReleaseImageBuffer，
+// 因此ISP（或拜耳原始数据复制、交给并行ISP前的复制）在回调内完成，之后原始缓冲区即可复用
+void MVCamera::onFrame(BYTE *_pFrameBuffer, tSdkFrameHead *_pFrameHead)
+{
+    auto ready_time = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(callback_mutex);
+    if (!capturing)
+        return;
+
+    if (offthread_isp)
     {
-        isindustry_camera_open = false;
+        isp_pool.submit(_pFrameBuffer, *_pFrameHead, ready_time);
+        return;
     }
 
-    return isindustry_camera_open;
+    cv::Mat processed;
+    processFrame(_pFrameBuffer, _pFrameHead, processed);
+    mailbox.publish(processed, ready_time);
+}
+
+// 取最新一帧
+bool MVCamera::latestFrame(cv::Mat &_frame, std::chrono::steady_clock::time_point *ready_time)
+{
+    return mailbox.wait(_frame, ready_time);
+}
+
+// 丢帧数
+int64_t MVCamera::droppedFrames() const
+{
+    return mailbox.dropped() + isp_pool.dropped();
+}
+
+// 相机分辨率
+cv::Size MVCamera::frameSize() const
+{
+    return frame_size;
+}
+
+// 拜耳排列
+std::string MVCamera::bayerPattern() const
+{
+    return raw_bayer ? bayer_pattern : std::string();
+}
+
+// 白平衡增益
+cv::Scalar MVCamera::whiteBalance()
+{
+    int r_gain = 100, g_gain = 100, b_gain = 100;
+    if (iscamera0_open)
+        CameraGetGain(hCamera, &r_gain, &g_gain, &b_gain);
+    return cv::Scalar(b_gain / 100.0, g_gain / 100.0, r_gain / 100.0);
 }
 
 // 清除缓存
@@ -2,9 +2,17 @@
 #define MV_CAMERA_HPP
 
 #include "CameraApi.h"
+#include "FrameMailbox.hpp"
+#include "FrameSource.hpp"
+#include "FramePool.hpp"
+#include "IspWorkerPool.hpp"
 #include "opencv2/core/core.hpp"
 #include "opencv2/highgui/highgui.hpp"
-#include <opencv2/imgproc/imgproc_c.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
 namespace mindvision
 {
 enum EXPOSURETIME // 相机曝光时间
@@ -28,6 +36,13 @@ enum RESOLUTION // 相机分辨率
     RESOLUTION_640_X_480,
 };
 
+enum ACQUISITION // 采集方式
+{
+
+    ACQUISITION_CALLBACK, // SDK帧回调，帧就绪后立即处理
+    ACQUISITION_POLLING,  // 采集线程轮询 CameraGetImageBuffer
+};
+
 struct Camera_Resolution // 设置相机分辨率
 {
     int cols;
@@ -65,23 +80,30 @@ struct CameraParam
 {
     int camera_mode;
     int camera_exposuretime;
+    int frame_pool_size; // 图像缓冲池大小，应大于下游同时持有的帧数（推理中、显示中与采集中的帧，以及ISP工作线程数）
+    int acquisition;     // 采集方式，回调注册失败时回退到轮询
+    bool raw_bayer;      // 输出未经ISP的8位拜耳原始图像，去马赛克由识别器在缩放时完成
+    int isp_workers;     // 非0时ISP在独立线程中执行（最多1个线程），0为在采集线程（或SDK回调）中处理
 
     mindvision::Camera_Resolution resolution;
 
     CameraParam(const int _camera_mode, const mindvision::RESOLUTION _resolution,
-                const mindvision::EXPOSURETIME _camera_exposuretime)
-        : camera_mode(_camera_mode), camera_exposuretime(_camera_exposuretime), resolution(_resolution)
+                const mindvision::EXPOSURETIME _camera_exposuretime, const int _frame_pool_size = 6,
+                const mindvision::ACQUISITION _acquisition = mindvision::ACQUISITION_CALLBACK,
+                const bool _raw_bayer = false, const int _isp_workers = 0)
+        : camera_mode(_camera_mode), camera_exposuretime(_camera_exposuretime), frame_pool_size(_frame_pool_size),
+          acquisition(_acquisition), raw_bayer(_raw_bayer), isp_workers(_isp_workers), resolution(_resolution)
     {
     }
 };
 
-class MVCamera
+class MVCamera : public FrameSource
 {
   public:
     MVCamera() = default;
     explicit MVCamera(const mindvision::CameraParam &_camera_param);
 
-    ~MVCamera();
+    ~MVCamera() override;
 
     // 相机初始化
     int cameraInit(const int _CAMERA_RESOLUTION_COLS, const int _CAMERA_RESOLUTION_ROWS,
@@ -90,17 +112,72 @@ class MVCamera
     // 相机是否在线
     bool isCameraOnline();
 
-    // 获取图像
+    // 获取图像，与相机共享缓冲池中的缓冲区，所有引用释放后归还
     inline cv::Mat image() const
     {
-        return cv::cvarrToMat(iplImage, true);
+        return frame;
     }
 
     // 清除缓存
     void releaseBuff();
 
+    // 启动采集（SDK回调或采集线程），持续采集并只保留最新一帧；启动后不再调用 isCameraOnline / image / releaseBuff
+    bool startCapture() override;
+
+    // 停止采集
+    void stopCapture() override;
+
+    // 取最新一帧，没有新帧时等待；ready_time 返回SDK交付该帧的时间；采集停止后返回false
+    bool latestFrame(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time = nullptr) override;
+
+    // 未被取走就被新帧覆盖的帧数
+    int64_t droppedFrames() const override;
+
+    // 相机分辨率
+    cv::Size frameSize() const override;
+
+    // 拜耳原始图像模式下左上2x2单元的颜色排列（如"BGGR"），否则为空
+    std::string bayerPattern() const override;
+
+    // ISP使用的白平衡增益（B G R），拜耳原始图像模式下由识别器应用
+    cv::Scalar whiteBalance() override;
+
   private:
-    unsigned char *g_pRgbBuffer; // 处理后数据缓存区
+    // 采集并处理一帧，成功时更新frame
+    bool grabFrame();
+
+    // 将SDK原始缓冲区处理为BGR，或在拜耳原始图像模式下直接复制，结果写入缓冲池
+    void processFrame(BYTE *_pFrameBuffer, tSdkFrameHead *_pFrameHead, cv::Mat &_frame);
+
+    // 选择8位拜耳输出格式，失败时回到ISP输出
+    void selectRawFormat();
+
+    // 采集线程
+    void captureLoop();
+
+    // SDK帧回调，在SDK采集线程中调用
+    static void frameCallback(CameraHandle _hCamera, BYTE *_pFrameBuffer, tSdkFrameHead *_pFrameHead, PVOID _pContext);
+
+    // 处理回调交付的一帧并发布
+    void onFrame(BYTE *_pFrameBuffer, tSdkFrameHead *_pFrameHead);
+
+    FramePool frame_pool;                              // 处理后图像缓冲池
+    int frame_pool_size = 6;                           // 缓冲池大小
+    int acquisition = ACQUISITION_CALLBACK;            // 采集方式
+    bool raw_bayer = false;                            // 输出拜耳原始图像
+    int isp_workers = 0;                               // ISP工作线程数（0或1）
+    cv::Size frame_size;                               // 相机分辨率
+    std::string bayer_pattern;                         // 拜耳排列
+    cv::Mat frame;                                     // 最新一帧（占用缓冲池中的一块）
+    std::chrono::steady_clock::time_point frame_ready; // 最新一帧的就绪时间
+
+    FrameMailbox mailbox;               // 采集输出的最新帧
+    IspWorkerPool isp_pool;             // 独立线程ISP
+    bool offthread_isp = false;         // 原始数据交给独立线程ISP处理
+    std::thread capture_thread;         // 轮询方式的采集线程
+    std::atomic<bool> capturing{false}; // 采集运行中
+    bool callback_registered = false;   // 已注册SDK帧回调
+    std::mutex callback_mutex;          // 停止采集时等待正在执行的回调返回
 
     int iCameraCounts = 1;
     int iStatus = -1;
@@ -115,7 +192,6 @@ class MVCamera
     tSdkImageResolution pImageResolution;
     BYTE *pbyBuffer;
     BOOL AEstate = FALSE;
-    IplImage *iplImage = nullptr;
 };
 
 } // namespace mindvision
@@ -0,0 +1,183 @@
+#include "ReplaySource.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+ReplaySource::ReplaySource(const std::string &_path, bool _realtime, bool _loop, double _image_fps)
+    : path(_path), realtime(_realtime), loop(_loop), image_fps(_image_fps > 0 ? _image_fps : 100)
+{
+    if (std::filesystem::is_directory(path))
+    {
+        for (const char *pattern : {"/*.jpg", "/*.png", "/*.bmp"})
+        {
+            std::vector<cv::String> paths;
+            cv::glob(path + pattern, paths);
+            images.insert(images.end(), paths.begin(), paths.end());
+        }
+        std::sort(images.begin(), images.end());
+
+        std::ifstream times_file(path + "/timestamps.txt");
+        double timestamp;
+        while (times_file >> timestamp)
+            image_times.push_back(timestamp);
+        if (!image_times.empty() && image_times.size() != images.size())
+        {
+            std::cout << "Error, " << image_times.size() << " timestamps for " << images.size()
+                      << " images, replay at " << image_fps << " fps" << std::endl;
+            image_times.clear();
+        }
+
+        if (!images.empty())
+            frame_size = cv::imread(images[0]).size();
+    }
+    else if (video.open(path))
+    {
+        frame_size = cv::Size(video.get(cv::CAP_PROP_FRAME_WIDTH), video.get(cv::CAP_PROP_FRAME_HEIGHT));
+        video_fps = video.get(cv::CAP_PROP_FPS);
+    }
+
+    if (frame_size.empty())
+        std::cout << "Error, cannot replay " << path << std::endl;
+    else
+        std::cout << "Replaying " << path << (realtime ? " at recorded timing" : " as fast as possible") << std::endl;
+}
+
+ReplaySource::~ReplaySource()
+{
+    stopCapture();
+}
+
+bool ReplaySource::isOpened() const
+{
+    return !frame_size.empty();
+}
+
+// 启动回放线程
+bool ReplaySource::startCapture()
+{
+    if (!isOpened())
+    {
+        mailbox.close();
+        return false;
+    }
+    if (replaying)
+        return true;
+
+    mailbox.open();
+    replaying = true;
+    replay_thread = std::thread(&ReplaySource::replayLoop, this);
+    return true;
+}
+
+// 停止回放线程
+void ReplaySource::stopCapture()
+{
+    replaying = false;
+
+    // 关闭邮箱以唤醒等待新帧被取走的回放线程
+    mailbox.close();
+    if (replay_thread.joinable())
+        replay_thread.join();
+}
+
+// 取最新一帧
+bool ReplaySource::latestFrame(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time)
+{
+    return mailbox.wait(frame, ready_time);
+}
+
+// 丢帧数
+int64_t ReplaySource::droppedFrames() const
+{
+    return mailbox.dropped();
+}
+
+// 图像尺寸
+cv::Size ReplaySource::frameSize() const
+{
+    return frame_size;
+}
+
+// 回到第一帧
+bool ReplaySource::rewind()
+{
+    if (!images.empty())
+    {
+        image_index = 0;
+        return true;
+    }
+    video_index = 0;
+    return video.set(cv::CAP_PROP_POS_FRAMES, 0) || video.open(path);
+}
+
+// 读取下一帧
+bool ReplaySource::readFrame(cv::Mat &frame, double &timestamp)
+{
+    if (images.empty())
+    {
+        if (!video.read(frame))
+            return false;
+
+        // 部分后端不提供时间戳，按帧率推算
+        timestamp = video.get(cv::CAP_PROP_POS_MSEC);
+        if (timestamp <= 0 && video_index > 0)
+            timestamp = video_index * 1000.0 / (video_fps > 0 ? video_fps : 30);
+        video_index++;
+        return true;
+    }
+
+    // 跳过无法读取的图像
+    for (; image_index < images.size(); image_index++)
+    {
+        frame = cv::imread(images[image_index]);
+        if (frame.empty())
+            continue;
+        timestamp = image_times.empty() ? image_index * 1000.0 / image_fps : image_times[image_index];
+        image_index++;
+        return true;
+    }
+    return false;
+}
+
+// 回放线程
+void ReplaySource::replayLoop()
+{
+    cv::Mat frame;
+    double timestamp = 0;
+    double first_timestamp = -1;
+    auto first_time = std::chrono::steady_clock::now();
+
+    while (replaying)
+    {
+        if (!readFrame(frame, timestamp))
+        {
+            if (!loop || !rewind())
+                break;
+            first_timestamp = -1;
+            continue;
+        }
+
+        if (realtime)
+        {
+            // 按录制时间戳发布，推理跟不上时与相机一样只保留最新一帧
+            if (first_timestamp < 0)
+            {
+                first_timestamp = timestamp;
+                first_time = std::chrono::steady_clock::now();
+            }
+            std::this_thread::sleep_until(
+                first_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double, std::milli>(timestamp - first_timestamp)));
+        }
+        else if (!mailbox.waitTaken())
+        {
+            // 尽快模式等上一帧被取走，每帧都被处理
+            break;
+        }
+
+        mailbox.publish(frame, std::chrono::steady_clock::now());
+        frame.release();
+    }
+    mailbox.close();
+}
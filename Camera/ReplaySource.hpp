@@ -0,0 +1,67 @@
+#ifndef REPLAY_SOURCE_HPP
+#define REPLAY_SOURCE_HPP
+
+#include "FrameMailbox.hpp"
+#include "FrameSource.hpp"
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 录像回放图像源，不依赖相机与MindVision SDK
+ *
+ * 读取视频文件，或按文件名顺序读取目录中的图像。实时模式按录制时间戳发布，推理跟不上时与相机一样丢弃旧帧；
+ * 尽快模式在上一帧被取走后立即发布下一帧，每帧都被处理，用于测量整条流水线的吞吐。
+ * 图像目录的时间戳来自目录中的 timestamps.txt（每行一个毫秒时间戳，与排序后的图像一一对应），没有时按固定帧率。
+ */
+class ReplaySource : public FrameSource
+{
+  public:
+    /**
+     * @param path Video file, or directory of images.
+     * @param realtime Emit frames at their recorded timestamps, otherwise as soon as the previous one is taken.
+     * @param loop Restart from the first frame at the end instead of stopping.
+     * @param image_fps Frame rate of an image directory without timestamps.txt.
+     */
+    explicit ReplaySource(const std::string &path, bool realtime = true, bool loop = false, double image_fps = 100);
+    ~ReplaySource() override;
+
+    // 是否成功打开
+    bool isOpened() const;
+
+    bool startCapture() override;
+    void stopCapture() override;
+    bool latestFrame(cv::Mat &frame, std::chrono::steady_clock::time_point *ready_time = nullptr) override;
+    int64_t droppedFrames() const override;
+    cv::Size frameSize() const override;
+
+  private:
+    // 回到第一帧
+    bool rewind();
+
+    // 读取下一帧及其录制时间戳（毫秒）
+    bool readFrame(cv::Mat &frame, double &timestamp);
+
+    // 回放线程
+    void replayLoop();
+
+    std::string path;                // 视频文件或图像目录
+    bool realtime = true;            // 按录制时间戳发布
+    bool loop = false;               // 循环回放
+    double image_fps = 100;          // 图像目录的帧率
+    cv::Size frame_size;             // 图像尺寸
+    cv::VideoCapture video;          // 视频文件
+    int64_t video_index = 0;         // 已读取的视频帧数
+    double video_fps = 0;            // 视频帧率，时间戳无效时使用
+    std::vector<std::string> images; // 目录中的图像（按文件名排序）
+    std::vector<double> image_times; // 图像的录制时间戳（毫秒），为空时按固定帧率
+    size_t image_index = 0;          // 下一张图像
+
+    mindvision::FrameMailbox mailbox;   // 回放输出的最新帧
+    std::thread replay_thread;          // 回放线程
+    std::atomic<bool> replaying{false}; // 回放线程运行中
+};
+
+#endif
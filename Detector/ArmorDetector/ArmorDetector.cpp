@@ -3,21 +3,34 @@
 
 #include "ArmorDetector.hpp"
 #include "core/hal/interface.h"
+#include <cfloat>
+#include <chrono>
 #include <cmath>
+#include <sstream>
+#include <opencv2/core/hal/intrin.hpp>
+#include <openvino/op/add.hpp>
+#include <openvino/op/concat.hpp>
+#include <openvino/op/constant.hpp>
+#include <openvino/op/convert.hpp>
+#include <openvino/op/gather.hpp>
+#include <openvino/op/greater_eq.hpp>
+#include <openvino/op/multiply.hpp>
+#include <openvino/op/pad.hpp>
+#include <openvino/op/select.hpp>
+#include <openvino/op/slice.hpp>
+#include <openvino/op/squeeze.hpp>
+#include <openvino/op/topk.hpp>
 
 using namespace armor_detector;
 
-// static constexpr int INPUT_W = 640;    // Width of input
-// static constexpr int INPUT_H = 384;    // Height of input
-static constexpr int INPUT_W = 416;   // Width of input
-static constexpr int INPUT_H = 416;   // Height of input
-static constexpr int NUM_CLASSES = 8; // Number of classes
-static constexpr int NUM_COLORS = 4;  // Number of color
-static constexpr int TOPK = 128;      // TopK
+static constexpr int TOPK = 128; // TopK
 static constexpr float NMS_THRESH = 0.3;
 static constexpr float BBOX_CONF_THRESH = 0.6;
 static constexpr float FFT_CONF_ERROR = 0.15;
 static constexpr float FFT_MIN_IOU = 0.9;
+static constexpr int TILE_EDGE_MARGIN = 2;       // 分块内紧贴内部边界的候选视为被截断
+static constexpr int GRAPH_DECODE_DIM = 11;      // 图内解码输出: 4个角点 置信度 颜色 类别
+static constexpr int LATENCY_PROBE_FRAMES = 100; // 档位耗时超过该帧数未测量时视为未知，重新试探
 
 static inline int argmax(const float *ptr, int len)
 {
@@ -34,9 +47,12 @@ static inline int argmax(const float *ptr, int len)
  * @brief Resize the image using letterbox
  * @param img Image before resize
  * @param transform_matrix Transform Matrix of Resize
+ * @param INPUT_W Width of network input
+ * @param INPUT_H Height of network input
  * @return Image after resize
  */
-inline cv::Mat scaledResize(cv::Mat &img, Eigen::Matrix<float, 3, 3> &transform_matrix)
+inline cv::Mat scaledResize(cv::Mat &img, Eigen::Matrix<float, 3, 3> &transform_matrix, const int INPUT_W,
+                            const int INPUT_H)
 {
     float r = std::min(INPUT_W / (img.cols * 1.0), INPUT_H / (img.rows * 1.0));
     int unpad_w = r * img.cols;
@@ -59,15 +75,18 @@ inline cv::Mat scaledResize(cv::Mat &img, Eigen::Matrix<float, 3, 3> &transform_
 }
 
 /**
- * @brief Generate grids and stride.
+ * @brief Generate grids and stride in SoA form.
  * @param target_w Width of input.
  * @param target_h Height of input.
  * @param strides A vector of stride.
- * @param grid_strides Grid stride generated in this function.
+ * @param net Grid tables of net are filled in this function.
  */
 static void generate_grids_and_stride(const int target_w, const int target_h, std::vector<int> &strides,
-                                      std::vector<GridAndStride> &grid_strides)
+                                      NetGeometry &net)
 {
+    net.grid_x.clear();
+    net.grid_y.clear();
+    net.grid_stride.clear();
     for (auto stride : strides)
     {
         int num_grid_w = target_w / stride;
@@ -77,263 +96,990 @@ static void generate_grids_and_stride(const int target_w, const int target_h, st
         {
             for (int g0 = 0; g0 < num_grid_w; g0++)
             {
-                grid_strides.push_back((GridAndStride){g0, g1, stride});
+                net.grid_x.push_back(g0);
+                net.grid_y.push_back(g1);
+                net.grid_stride.push_back(stride);
             }
         }
     }
+
+    // 各候选置信度在输出中的位置，供SIMD gather使用
+    const int dim = 9 + net.num_colors + net.num_classes;
+    net.obj_offsets.resize(net.grid_x.size());
+    for (int i = 0; i < (int)net.obj_offsets.size(); i++)
+        net.obj_offsets[i] = i * dim + 8;
+}
+
+/**
+ * @brief Same rounding as cv::boundingRect on float points.
+ */
+static inline cv::Rect_<float> apexBoundingRect(const cv::Point2f apex[4])
+{
+    float x_min = apex[0].x, x_max = apex[0].x, y_min = apex[0].y, y_max = apex[0].y;
+    for (int i = 1; i < 4; i++)
+    {
+        x_min = std::min(x_min, apex[i].x);
+        x_max = std::max(x_max, apex[i].x);
+        y_min = std::min(y_min, apex[i].y);
+        y_max = std::max(y_max, apex[i].y);
+    }
+    int x0 = cvFloor(x_min), y0 = cvFloor(y_min);
+    return cv::Rect_<float>(x0, y0, cvFloor(x_max) - x0 + 1, cvFloor(y_max) - y0 + 1);
+}
+
+/**
+ * @brief Decode one anchor that passed the objectness threshold.
+ */
+template <int COLORS, int CLASSES>
+static inline void decodeAnchor(const NetGeometry &net, const float *feat_ptr, int anchor_idx,
+                                const Eigen::Matrix<float, 3, 3> &transform_matrix, std::vector<ArmorObject> &objects)
+{
+    const int NUM_COLORS = COLORS > 0 ? COLORS : net.num_colors;
+    const int NUM_CLASSES = CLASSES > 0 ? CLASSES : net.num_classes;
+    const float *p = feat_ptr + anchor_idx * (9 + NUM_COLORS + NUM_CLASSES);
+
+    const float grid0 = net.grid_x[anchor_idx];
+    const float grid1 = net.grid_y[anchor_idx];
+    const float stride = net.grid_stride[anchor_idx];
+
+    // letterbox变换只含缩放与平移，直接展开为仿射运算
+    const float m00 = transform_matrix(0, 0), m01 = transform_matrix(0, 1), m02 = transform_matrix(0, 2);
+    const float m10 = transform_matrix(1, 0), m11 = transform_matrix(1, 1), m12 = transform_matrix(1, 2);
+
+    objects.emplace_back();
+    ArmorObject &obj = objects.back();
+
+    // yolox/models/yolo_head.py decode logic
+    //  outputs[..., :2] = (outputs[..., :2] + grids) * strides
+    for (int i = 0; i < 4; i++)
+    {
+        float x = (p[i * 2] + grid0) * stride;
+        float y = (p[i * 2 + 1] + grid1) * stride;
+        obj.apex[i] = cv::Point2f(m00 * x + m01 * y + m02, m10 * x + m11 * y + m12);
+        obj.vote_sum[i] = obj.apex[i];
+    }
+    obj.vote_count = 1;
+    obj.rect = apexBoundingRect(obj.apex);
+
+    obj.color = argmax(p + 9, NUM_COLORS);
+    obj.cls = argmax(p + 9 + NUM_COLORS, NUM_CLASSES);
+    obj.distinguish = armorSize(obj.cls);
+    // float box_prob = (box_objectness + cls_conf + color_conf) / 3.0;
+    obj.prob = p[8];
 }
 
 /**
  * @brief Generate Proposal
- * @param grid_strides Grid strides
+ * @tparam COLORS Number of colors known at compile time, 0 for the generic kernel.
+ * @tparam CLASSES Number of classes known at compile time, 0 for the generic kernel.
+ * @param net Network geometry.
  * @param feat_ptr Original predition result.
  * @param prob_threshold Confidence Threshold.
  * @param objects Objects proposed.
  */
-static void generateYoloxProposals(std::vector<GridAndStride> grid_strides, const float *feat_ptr,
+template <int COLORS, int CLASSES>
+static void generateYoloxProposals(const NetGeometry &net, const float *feat_ptr,
                                    Eigen::Matrix<float, 3, 3> &transform_matrix, float prob_threshold,
                                    std::vector<ArmorObject> &objects)
 {
+    const int num_anchors = net.num_anchors;
+    const int *obj_offsets = net.obj_offsets.data();
+    int anchor_idx = 0;
+
+#if CV_SIMD
+    // 绝大多数候选的置信度低于阈值，先按向量宽度gather置信度整体判断
+    const int VECSZ = CV_SIMD_WIDTH / sizeof(float);
+    for (; anchor_idx <= num_anchors - VECSZ; anchor_idx += VECSZ)
+    {
+        cv::v_float32 objectness = cv::v_lut(feat_ptr, obj_offsets + anchor_idx);
+        if (cv::v_reduce_max(objectness) < prob_threshold)
+            continue;
 
-    const int num_anchors = grid_strides.size();
-    // Travel all the anchors
-    for (int anchor_idx = 0; anchor_idx < num_anchors; anchor_idx++)
+        for (int i = anchor_idx; i < anchor_idx + VECSZ; i++)
+        {
+            if (feat_ptr[obj_offsets[i]] >= prob_threshold)
+                decodeAnchor<COLORS, CLASSES>(net, feat_ptr, i, transform_matrix, objects);
+        }
+    }
+#endif
+    // Travel the remaining anchors
+    for (; anchor_idx < num_anchors; anchor_idx++)
     {
-        const int grid0 = grid_strides[anchor_idx].grid0;
-        const int grid1 = grid_strides[anchor_idx].grid1;
-        const int stride = grid_strides[anchor_idx].stride;
+        if (feat_ptr[obj_offsets[anchor_idx]] >= prob_threshold)
+            decodeAnchor<COLORS, CLASSES>(net, feat_ptr, anchor_idx, transform_matrix, objects);
+    }
+}
 
-        const int basic_pos = anchor_idx * (9 + NUM_COLORS + NUM_CLASSES);
+/**
+ * @brief Decode the candidates of a network with appendGraphDecode applied.
+ *        They are already in network coordinates and sorted by descending confidence.
+ */
+static void generateGraphProposals(const NetGeometry &net, const float *feat_ptr,
+                                   Eigen::Matrix<float, 3, 3> &transform_matrix, float prob_threshold,
+                                   std::vector<ArmorObject> &objects)
+{
+    const float m00 = transform_matrix(0, 0), m01 = transform_matrix(0, 1), m02 = transform_matrix(0, 2);
+    const float m10 = transform_matrix(1, 0), m11 = transform_matrix(1, 1), m12 = transform_matrix(1, 2);
 
-        // yolox/models/yolo_head.py decode logic
-        //  outputs[..., :2] = (outputs[..., :2] + grids) * strides
-        //  outputs[..., 2:4] = torch.exp(outputs[..., 2:4]) * strides
-        float x_1 = (feat_ptr[basic_pos + 0] + grid0) * stride;
-        float y_1 = (feat_ptr[basic_pos + 1] + grid1) * stride;
-        float x_2 = (feat_ptr[basic_pos + 2] + grid0) * stride;
-        float y_2 = (feat_ptr[basic_pos + 3] + grid1) * stride;
-        float x_3 = (feat_ptr[basic_pos + 4] + grid0) * stride;
-        float y_3 = (feat_ptr[basic_pos + 5] + grid1) * stride;
-        float x_4 = (feat_ptr[basic_pos + 6] + grid0) * stride;
-        float y_4 = (feat_ptr[basic_pos + 7] + grid1) * stride;
+    for (int k = 0; k < net.graph_topk; k++)
+    {
+        const float *p = feat_ptr + k * GRAPH_DECODE_DIM;
+        // 之后的候选置信度均低于阈值
+        if (p[8] < prob_threshold)
+            break;
+
+        objects.emplace_back();
+        ArmorObject &obj = objects.back();
+        for (int i = 0; i < 4; i++)
+        {
+            obj.apex[i] = cv::Point2f(m00 * p[i * 2] + m01 * p[i * 2 + 1] + m02,
+                                      m10 * p[i * 2] + m11 * p[i * 2 + 1] + m12);
+            obj.vote_sum[i] = obj.apex[i];
+        }
+        obj.vote_count = 1;
+        obj.rect = apexBoundingRect(obj.apex);
 
-        int box_color = argmax(feat_ptr + basic_pos + 9, NUM_COLORS);
-        int box_class = argmax(feat_ptr + basic_pos + 9 + NUM_COLORS, NUM_CLASSES);
+        obj.color = p[9];
+        obj.cls = p[10];
+        obj.distinguish = armorSize(obj.cls);
+        obj.prob = p[8];
+    }
+}
 
-        float box_objectness = (feat_ptr[basic_pos + 8]);
+/**
+ * @brief Decode the proposals of one network output and append them in image coordinates.
+ * @param prob Original predition output.
+ * @param net Network geometry.
+ * @param transform_matrix Transform from network coordinates to image coordinates.
+ * @param proposals Proposals are appended to it.
+ */
+static void appendProposals(const float *prob, const NetGeometry &net, Eigen::Matrix<float, 3, 3> &transform_matrix,
+                            std::vector<ArmorObject> &proposals)
+{
+    // 常见输出结构使用编译期展开的解码，其余情况使用通用解码
+    if (net.graph_topk > 0)
+        generateGraphProposals(net, prob, transform_matrix, BBOX_CONF_THRESH, proposals);
+    else if (net.num_colors == 4 && net.num_classes == 8)
+        generateYoloxProposals<4, 8>(net, prob, transform_matrix, BBOX_CONF_THRESH, proposals);
+    else if (net.num_colors == 4 && net.num_classes == 9)
+        generateYoloxProposals<4, 9>(net, prob, transform_matrix, BBOX_CONF_THRESH, proposals);
+    else
+        generateYoloxProposals<0, 0>(net, prob, transform_matrix, BBOX_CONF_THRESH, proposals);
+}
 
-        float color_conf = (feat_ptr[basic_pos + 9 + box_color]);
-        float cls_conf = (feat_ptr[basic_pos + 9 + NUM_COLORS + box_class]);
+/**
+ * @brief Drop tile proposals cut by an inner tile border, the neighbouring tile or the full frame sees them whole.
+ * @param proposals Proposals, only those from index first on belong to the tile.
+ * @param first Index of the first proposal of the tile.
+ * @param tile Region of the tile in the image.
+ * @param img_w Width of Image.
+ * @param img_h Height of Image.
+ */
+static void dropTileEdgeProposals(std::vector<ArmorObject> &proposals, size_t first, const cv::Rect &tile,
+                                  const int img_w, const int img_h)
+{
+    const bool inner_left = tile.x > 0;
+    const bool inner_top = tile.y > 0;
+    const bool inner_right = tile.x + tile.width < img_w;
+    const bool inner_bottom = tile.y + tile.height < img_h;
+
+    auto cut = [&](const ArmorObject &object) {
+        return (inner_left && object.rect.x <= tile.x + TILE_EDGE_MARGIN) ||
+               (inner_top && object.rect.y <= tile.y + TILE_EDGE_MARGIN) ||
+               (inner_right && object.rect.x + object.rect.width >= tile.x + tile.width - TILE_EDGE_MARGIN) ||
+               (inner_bottom && object.rect.y + object.rect.height >= tile.y + tile.height - TILE_EDGE_MARGIN);
+    };
+    proposals.erase(std::remove_if(proposals.begin() + first, proposals.end(), cut), proposals.end());
+}
 
-        // float box_prob = (box_objectness + cls_conf + color_conf) / 3.0;
-        float box_prob = box_objectness;
+/**
+ * @brief Keep the most confident proposals and suppress duplicates.
+ * @param proposals Proposals in image coordinates.
+ * @param picked Reused storage for NMS result.
+ * @param nms NMS engine.
+ * @param topk Number of proposals kept before NMS.
+ * @param objects Vector of objects predicted.
+ * @param img_w Width of Image.
+ * @param img_h Height of Image.
+ */
+static void decodeOutputs(std::vector<ArmorObject> &proposals, std::vector<int> &picked, NmsEngine &nms,
+                          const int topk, std::vector<ArmorObject> &objects, const int img_w, const int img_h)
+{
+    selectTopK(proposals, topk);
+    nms.run(proposals, picked, img_w, img_h);
+    int count = picked.size();
+    objects.resize(count);
 
-        if (box_prob >= prob_threshold)
-        {
-            ArmorObject obj;
+    for (int i = 0; i < count; i++)
+    {
+        objects[i] = proposals[picked[i]];
+    }
+}
 
-            Eigen::Matrix<float, 3, 4> apex_norm;
-            Eigen::Matrix<float, 3, 4> apex_dst;
+ArmorDetector::ArmorDetector()
+{
+}
 
-            apex_norm << x_1, x_2, x_3, x_4, y_1, y_2, y_3, y_4, 1, 1, 1, 1;
+ArmorDetector::~ArmorDetector()
+{
+    // 等待回调全部返回后再析构
+    for (; slots_in_flight > 0; slots_in_flight--, slot_head = (slot_head + 1) % infer_slots.size())
+        waitSlot(infer_slots[slot_head]);
+}
 
-            apex_dst = transform_matrix * apex_norm;
+bool ArmorDetector::readConfig(string config_path)
+{
+    cv::FileStorage fs_detector(config_path, cv::FileStorage::READ);
+    if (!fs_detector.isOpened())
+    {
+        std::cout << " ERROR: 无法打开识别器配置文件 " << config_path << std::endl;
+        return false;
+    }
 
-            for (int i = 0; i < 4; i++)
-            {
-                obj.apex[i] = cv::Point2f(apex_dst(0, i), apex_dst(1, i));
-                obj.pts.push_back(obj.apex[i]);
-            }
+    if (!fs_detector["BACKEND"].empty())
+        fs_detector["BACKEND"] >> detector_config.backend;
+    if (!fs_detector["MODEL"].empty())
+        fs_detector["MODEL"] >> detector_config.model;
+    if (!fs_detector["DEVICE"].empty())
+        fs_detector["DEVICE"] >> detector_config.device;
+    if (!fs_detector["INPUT_WIDTH"].empty())
+        fs_detector["INPUT_WIDTH"] >> detector_config.input_width;
+    if (!fs_detector["INPUT_HEIGHT"].empty())
+        fs_detector["INPUT_HEIGHT"] >> detector_config.input_height;
+    if (!fs_detector["USE_OV_PREPROCESS"].empty())
+        fs_detector["USE_OV_PREPROCESS"] >> detector_config.use_ov_preprocess;
+    if (!fs_detector["INFER_REQUESTS"].empty())
+        fs_detector["INFER_REQUESTS"] >> detector_config.infer_requests;
+    if (!fs_detector["PERFORMANCE_MODE"].empty())
+        fs_detector["PERFORMANCE_MODE"] >> detector_config.performance_mode;
+    if (!fs_detector["NUM_STREAMS"].empty())
+        fs_detector["NUM_STREAMS"] >> detector_config.num_streams;
+    if (!fs_detector["CACHE_DIR"].empty())
+        fs_detector["CACHE_DIR"] >> detector_config.cache_dir;
+    if (!fs_detector["ENABLE_MMAP"].empty())
+        fs_detector["ENABLE_MMAP"] >> detector_config.enable_mmap;
+    if (!fs_detector["WARMUP_ITERATIONS"].empty())
+        fs_detector["WARMUP_ITERATIONS"] >> detector_config.warmup_iterations;
+    if (!fs_detector["NUM_COLORS"].empty())
+        fs_detector["NUM_COLORS"] >> detector_config.num_colors;
+    if (!fs_detector["PROFILING_FRAMES"].empty())
+        fs_detector["PROFILING_FRAMES"] >> detector_config.profiling_frames;
+    if (!fs_detector["PROFILING_DUMP"].empty())
+        fs_detector["PROFILING_DUMP"] >> detector_config.profiling_dump;
+    if (!fs_detector["NMS_CLASS_AWARE"].empty())
+        fs_detector["NMS_CLASS_AWARE"] >> detector_config.nms_class_aware;
+    if (!fs_detector["ROI_MODE"].empty())
+        fs_detector["ROI_MODE"] >> detector_config.roi_mode;
+    if (!fs_detector["ROI_SCALE"].empty())
+        fs_detector["ROI_SCALE"] >> detector_config.roi_scale;
+    if (!fs_detector["ROI_LOST_FRAMES"].empty())
+        fs_detector["ROI_LOST_FRAMES"] >> detector_config.roi_lost_frames;
+    if (!fs_detector["TILE_MODE"].empty())
+        fs_detector["TILE_MODE"] >> detector_config.tile_mode;
+    if (!fs_detector["TILE_COLS"].empty())
+        fs_detector["TILE_COLS"] >> detector_config.tile_cols;
+    if (!fs_detector["TILE_ROWS"].empty())
+        fs_detector["TILE_ROWS"] >> detector_config.tile_rows;
+    if (!fs_detector["TILE_OVERLAP"].empty())
+        fs_detector["TILE_OVERLAP"] >> detector_config.tile_overlap;
+    if (!fs_detector["TILE_INTERVAL"].empty())
+        fs_detector["TILE_INTERVAL"] >> detector_config.tile_interval;
+    if (!fs_detector["RESOLUTION_LEVELS"].empty())
+        fs_detector["RESOLUTION_LEVELS"] >> detector_config.resolution_levels;
+    if (!fs_detector["LATENCY_BUDGET_MS"].empty())
+        fs_detector["LATENCY_BUDGET_MS"] >> detector_config.latency_budget_ms;
+    if (!fs_detector["GRAPH_DECODE"].empty())
+        fs_detector["GRAPH_DECODE"] >> detector_config.graph_decode;
+    if (!fs_detector["INFERENCE_PRECISION"].empty())
+        fs_detector["INFERENCE_PRECISION"] >> detector_config.inference_precision;
+    if (!fs_detector["INT8_MODEL"].empty())
+        fs_detector["INT8_MODEL"] >> detector_config.int8_model;
+
+    return true;
+}
 
-            vector<cv::Point2f> tmp(obj.apex, obj.apex + 4);
-            obj.rect = cv::boundingRect(tmp);
+// TODO:change to your dir
+bool ArmorDetector::initModel(string path)
+{
+    nms.setThreshold(NMS_THRESH);
+    nms.setVoting(FFT_MIN_IOU, FFT_CONF_ERROR);
+    nms.setClassAware(detector_config.nms_class_aware != 0);
 
-            obj.cls = box_class;
-            obj.color = box_color;
-            obj.prob = box_prob;
+    // 配置文件指定的模型优先于程序给出的路径
+    if (!detector_config.model.empty())
+        path = detector_config.model;
 
-            objects.push_back(obj);
+    const std::string &precision = detector_config.inference_precision;
+    if (!precision.empty() && precision != "FP32" && precision != "BF16" && precision != "FP16" &&
+        precision != "INT8")
+    {
+        std::cout << " ERROR: 未知的推理精度 " << precision << std::endl;
+        return false;
+    }
+    // INT8使用预先量化的模型
+    if (precision == "INT8")
+    {
+        if (detector_config.int8_model.empty())
+        {
+            std::cout << " ERROR: 推理精度为INT8时需要指定 INT8_MODEL" << std::endl;
+            return false;
         }
+        path = detector_config.int8_model;
+    }
+
+    // 其他推理后端同步推理，不经过OpenVINO原生流水线
+    if (detector_config.backend != "OPENVINO")
+        return initBackend(path);
 
-    } // point anchor loop
+    auto t1 = std::chrono::steady_clock::now();
+    // 配置相同的识别器共享已编译网络，只创建各自的推理请求
+    model_key = modelKey(path);
+    shared_model = ModelRegistry::instance().acquire<SharedModel>(model_key, [&]() { return loadModel(path); });
+    if (!shared_model)
+        return false;
+
+    model = shared_model->model;
+    net = shared_model->net;
+    compiled_model = shared_model->compiled_model;
+    levels = shared_model->levels;
+    level_latency.assign(levels.size() + 1, 0.0);
+    level_measured.assign(levels.size() + 1, 0);
+    proposals.reserve(net.num_anchors);
+    picked.reserve(TOPK);
+
+    // PrePostProcessor模式下输入尺寸取决于图像，在第一帧时再编译
+    if (detector_config.use_ov_preprocess)
+        return true;
+
+    createInferSlots();
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "Load model: " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+
+    // moutput = infer_request.get_output_tensor(0);
+
+    return true;
+
+    // // 1.Create Runtime Core
+    // // ov::Core ie;
+    // model = ie.read_model(path);
+
+    // // 2.Compile the model
+    // ov::CompiledModel compiled_model = ie.compile_model(path, "GPU");
+
+    // // 3.Create inference request
+    // infer_request = compiled_model.create_infer_request();
+
+    // // 4.Set inputs
+    // // Get input tensor by index
+    // input_tensor = infer_request.get_input_tensor(0);
+    // // IR v10 works with converted precisions (i64 -> i32)
+    // // auto data = input_tensor.data<int32_t>();
+    // // Fill first data ...
+
+    // return true;
 }
 
 /**
- * @brief Calculate intersection area between two objects.
- * @param a Object a.
- * @param b Object b.
- * @return Area of intersection.
+ * @brief Load the model with the backend named by BACKEND, frames are then inferred synchronously in submit().
+ * @return False if the backend or the model can not be used.
  */
-static inline float intersection_area(const ArmorObject &a, const ArmorObject &b)
+bool ArmorDetector::initBackend(const std::string &path)
 {
-    cv::Rect_<float> inter = a.rect & b.rect;
-    return inter.area();
+    auto t1 = std::chrono::steady_clock::now();
+    backend = createInferBackend(detector_config.backend, detector_config.device);
+    if (!backend || !backend->load(path, detector_config.input_width, detector_config.input_height))
+        return false;
+
+    const cv::Size input_size = backend->inputSize();
+    if (!buildGeometry(input_size.width, input_size.height, backend->numAnchors(), backend->outputDim(), net))
+        return false;
+
+    // 以下功能依赖OpenVINO原生接口
+    if (detector_config.use_ov_preprocess || detector_config.tile_mode || detector_config.graph_decode ||
+        !detector_config.resolution_levels.empty() || detector_config.profiling_frames > 0)
+    {
+        std::cout << backend->name() << " 后端不支持 USE_OV_PREPROCESS、TILE_MODE、GRAPH_DECODE、RESOLUTION_LEVELS "
+                  << "与 PROFILING_FRAMES，已关闭" << std::endl;
+        detector_config.use_ov_preprocess = 0;
+        detector_config.tile_mode = 0;
+        detector_config.graph_decode = 0;
+        detector_config.resolution_levels.clear();
+        detector_config.profiling_frames = 0;
+    }
+
+    levels.clear();
+    level_latency.assign(1, 0.0);
+    level_measured.assign(1, 0);
+    proposals.reserve(net.num_anchors);
+    picked.reserve(TOPK);
+    infer_slots.clear();
+    infer_slots.resize(1);
+
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "Load model (" << backend->name()
+              << "): " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+    return true;
 }
 
-static void qsort_descent_inplace(std::vector<ArmorObject> &faceobjects, int left, int right)
+/**
+ * @brief Run the slot on the backend, the slot is done when this returns.
+ */
+void ArmorDetector::inferBackend(InferSlot &slot)
+{
+    try
+    {
+        backend->infer();
+    }
+    catch (const std::exception &)
+    {
+        slot.error = std::current_exception();
+    }
+    slot.done_time = std::chrono::steady_clock::now();
+    slot.pending = 0;
+    slot.done = true;
+}
+
+/**
+ * @brief Registry key of the network, covers every config item that changes the compiled network.
+ */
+std::string ArmorDetector::modelKey(const std::string &path) const
 {
-    int i = left;
-    int j = right;
-    float p = faceobjects[(left + right) / 2].prob;
+    std::ostringstream key;
+    key << path << "|" << detector_config.device << "|" << detector_config.input_width << "x"
+        << detector_config.input_height << "|" << detector_config.use_ov_preprocess << "|"
+        << detector_config.performance_mode << "|" << detector_config.num_streams << "|"
+        << (detector_config.profiling_frames > 0) << "|" << detector_config.num_colors << "|"
+        << detector_config.graph_decode << "|" << detector_config.inference_precision << "|";
+    for (float value : detector_config.resolution_levels)
+        key << value << " ";
+    return key.str();
+}
 
-    while (i <= j)
+/**
+ * @brief Read, transform and compile the network, called by ModelRegistry for the first detector of a config.
+ * @return Nullptr if the model can not be used.
+ */
+std::shared_ptr<SharedModel> ArmorDetector::loadModel(const std::string &path)
+{
+    // 权重内存映射按本次读取指定，不修改进程内共享的 ov::Core
+#if OPENVINO_VERSION_MAJOR >= 2025
+    model = ie.read_model(path, {}, {ov::enable_mmap(detector_config.enable_mmap != 0)});
+#else
+    // 旧版本的 read_model 不接受属性，按默认方式（内存映射）读取
+    if (!detector_config.enable_mmap)
+        std::cout << "ENABLE_MMAP 0 需要 OpenVINO 2025.0 及以上版本，权重仍以内存映射方式读取" << std::endl;
+    model = ie.read_model(path);
+#endif
+    if (!reshapeInput(model, detector_config.input_width, detector_config.input_height) || !readGeometry(model, net))
+        return nullptr;
+
+    // 附加档位由未追加解码的模型重新调整输入尺寸
+    if (!detector_config.use_ov_preprocess && !compileLevels())
+        return nullptr;
+    if (detector_config.graph_decode && !appendGraphDecode(model, net))
+        return nullptr;
+    if (!detector_config.use_ov_preprocess)
     {
-        while (faceobjects[i].prob > p)
-            i++;
+        compiled_model = ie.compile_model(model, detector_config.device, compileConfig());
+        // 设备不支持所请求的精度时会回退，以实际生效的精度为准
+        std::cout << "Inference precision: " << compiled_model.get_property(ov::hint::inference_precision)
+                  << std::endl;
+    }
 
-        while (faceobjects[j].prob < p)
-            j--;
+    auto shared = std::make_shared<SharedModel>();
+    shared->model = model;
+    shared->net = net;
+    shared->compiled_model = compiled_model;
+    shared->levels = levels;
+    return shared;
+}
 
-        if (i <= j)
-        {
-            // swap
-            std::swap(faceobjects[i], faceobjects[j]);
+/**
+ * @brief Override the network input size from the config, must be called before initModel.
+ */
+void ArmorDetector::setInputSize(cv::Size size)
+{
+    detector_config.input_width = size.width;
+    detector_config.input_height = size.height;
+}
 
-            i++;
-            j--;
-        }
+/**
+ * @brief Override INFERENCE_PRECISION from the config, must be called before initModel.
+ * @param precision FP32, BF16, FP16, INT8, or empty for the device default.
+ */
+void ArmorDetector::setInferencePrecision(const std::string &precision)
+{
+    detector_config.inference_precision = precision;
+}
+
+/**
+ * @brief Feed the distance of the tracked target, e.g. from PoseSolver::getDistance().
+ * @param distance Distance in meters.
+ */
+void ArmorDetector::setTargetDistance(float distance)
+{
+    target_distance = distance;
+}
+
+/**
+ * @brief The armor currently tracked, valid while state is not LOST.
+ */
+const ArmorObject &ArmorDetector::getTarget() const
+{
+    return armor_object;
+}
+
+/**
+ * @brief Reshape the network input, e.g. to match the aspect ratio of the sensor.
+ * @param reshape_model Model to reshape.
+ * @param w Input width, the model is left unchanged if w or h is not positive.
+ * @param h Input height.
+ * @return False if the size is not stride aligned or the model can not be reshaped.
+ */
+bool ArmorDetector::reshapeInput(std::shared_ptr<ov::Model> &reshape_model, int w, int h)
+{
+    if (w <= 0 || h <= 0)
+        return true;
+
+    // 输出网格按最大步长32划分
+    if (w % 32 != 0 || h % 32 != 0)
+    {
+        std::cout << " ERROR: 网络输入尺寸 " << w << "x" << h << " 不是32的倍数" << std::endl;
+        return false;
     }
 
-#pragma omp parallel sections
+    try
     {
-#pragma omp section
-        {
-            if (left < j)
-                qsort_descent_inplace(faceobjects, left, j);
-        }
-#pragma omp section
-        {
-            if (i < right)
-                qsort_descent_inplace(faceobjects, i, right);
-        }
+        reshape_model->reshape(ov::PartialShape{1, 3, h, w});
     }
+    catch (const std::exception &e)
+    {
+        std::cout << " ERROR: 无法将网络输入调整为 " << w << "x" << h << " " << e.what() << std::endl;
+        return false;
+    }
+    return true;
 }
 
-static void qsort_descent_inplace(std::vector<ArmorObject> &objects)
+/**
+ * @brief Read input size and output layout from the loaded model and build the grid table.
+ * @param read_model Loaded model.
+ * @param geometry Geometry filled from the model.
+ * @return False if the model does not look like a YOLOX armor network.
+ */
+bool ArmorDetector::readGeometry(const std::shared_ptr<ov::Model> &read_model, NetGeometry &geometry)
 {
-    if (objects.empty())
-        return;
+    const ov::PartialShape input_shape = read_model->input().get_partial_shape();   // N C H W
+    const ov::PartialShape output_shape = read_model->output().get_partial_shape(); // N anchors (9 + colors + classes)
+    if (input_shape.rank().get_length() != 4 || input_shape[2].is_dynamic() || input_shape[3].is_dynamic() ||
+        output_shape.rank().get_length() != 3 || output_shape[1].is_dynamic() || output_shape[2].is_dynamic())
+    {
+        std::cout << " ERROR: 不支持的模型输入输出 " << input_shape << " -> " << output_shape << std::endl;
+        return false;
+    }
 
-    qsort_descent_inplace(objects, 0, objects.size() - 1);
+    return buildGeometry(input_shape[3].get_length(), input_shape[2].get_length(), output_shape[1].get_length(),
+                         output_shape[2].get_length(), geometry);
 }
 
-static void nms_sorted_bboxes(std::vector<ArmorObject> &faceobjects, std::vector<int> &picked, float nms_threshold)
+/**
+ * @brief Fill the geometry from the input size and output shape and build the grid table.
+ * @param input_w Network input width.
+ * @param input_h Network input height.
+ * @param num_anchors Number of anchors in the output.
+ * @param output_dim Number of values per anchor in the output.
+ * @param geometry Geometry to fill.
+ * @return False if the output does not match a YOLOX armor network of that input size.
+ */
+bool ArmorDetector::buildGeometry(int input_w, int input_h, int num_anchors, int output_dim, NetGeometry &geometry)
 {
-    picked.clear();
-
-    const int n = faceobjects.size();
+    geometry.input_w = input_w;
+    geometry.input_h = input_h;
+    geometry.num_anchors = num_anchors;
+    geometry.num_colors = detector_config.num_colors;
+    geometry.num_classes = output_dim - 9 - geometry.num_colors;
 
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++)
+    if (geometry.num_classes <= 0)
     {
-        areas[i] = faceobjects[i].rect.area();
+        std::cout << " ERROR: 模型输出长度 " << output_dim << " 与颜色数 " << geometry.num_colors << " 不匹配" << std::endl;
+        return false;
     }
 
-    for (int i = 0; i < n; i++)
+    std::vector<int> strides = {8, 16, 32};
+    generate_grids_and_stride(geometry.input_w, geometry.input_h, strides, geometry);
+
+    if ((int)geometry.grid_x.size() != geometry.num_anchors)
     {
-        ArmorObject &a = faceobjects[i];
+        std::cout << " ERROR: 模型输出候选数 " << num_anchors << " 与输入 " << input_w << "x" << input_h << " 不匹配"
+                  << std::endl;
+        return false;
+    }
 
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            ArmorObject &b = faceobjects[picked[j]];
+    std::cout << "Network input: " << geometry.input_w << "x" << geometry.input_h
+              << ", anchors: " << geometry.num_anchors << ", colors: " << geometry.num_colors
+              << ", classes: " << geometry.num_classes << std::endl;
+    return true;
+}
 
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            float iou = inter_area / union_area;
-            if (iou > nms_threshold)
-            {
-                keep = 0;
-                // Stored for FFT
-                if (iou > FFT_MIN_IOU && abs(a.prob - b.prob) < FFT_CONF_ERROR && a.cls == b.cls && a.color == b.color)
-                {
-                    for (int i = 0; i < 4; i++)
-                    {
-                        b.pts.push_back(a.apex[i]);
-                    }
-                }
-                // cout<<b.pts_x.size()<<endl;
-            }
+/**
+ * @brief Append grid decode, objectness threshold and TopK to the model output.
+ *        The model then outputs [1, TOPK, 11] candidates sorted by descending confidence, each row holding
+ *        4 apexes in network coordinates, confidence, color and class. Rows below the threshold have confidence -1.
+ * @param decode_model Model reshaped to its final input size.
+ * @param geometry Geometry read from the model, graph_topk is set on success.
+ * @return False if the operations can not be added to the model.
+ */
+bool ArmorDetector::appendGraphDecode(std::shared_ptr<ov::Model> &decode_model, NetGeometry &geometry)
+{
+    const int64_t num_colors = geometry.num_colors;
+    const int64_t dim = 9 + num_colors + geometry.num_classes;
+    const int64_t topk = std::min(TOPK, geometry.num_anchors);
+
+    // 网格坐标按角点展开为 [1, anchors, 8]，步长为 [1, anchors, 1]
+    std::vector<float> grids(geometry.num_anchors * 8);
+    for (int a = 0; a < geometry.num_anchors; a++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            grids[a * 8 + i * 2] = geometry.grid_x[a];
+            grids[a * 8 + i * 2 + 1] = geometry.grid_y[a];
         }
+    }
+    const size_t anchors = geometry.num_anchors;
+
+    auto scalar = [](ov::element::Type type, double value) {
+        return ov::op::v0::Constant::create(type, ov::Shape{}, {value});
+    };
+    auto axis_value = [](int64_t value) {
+        return ov::op::v0::Constant::create(ov::element::i64, ov::Shape{1}, {value});
+    };
+
+    try
+    {
+        std::shared_ptr<ov::op::v0::Result> raw_result = decode_model->get_results()[0];
+        const ov::Output<ov::Node> raw = raw_result->input_value(0);
+        auto slice = [&](int64_t begin, int64_t end) {
+            return std::make_shared<ov::op::v8::Slice>(raw, axis_value(begin), axis_value(end), axis_value(1),
+                                                       axis_value(2));
+        };
+        auto argmax = [&](int64_t begin, int64_t end) {
+            auto top1 = std::make_shared<ov::op::v3::TopK>(slice(begin, end), scalar(ov::element::i64, 1), 2,
+                                                           ov::op::TopKMode::MAX, ov::op::TopKSortType::NONE);
+            return std::make_shared<ov::op::v0::Convert>(top1->output(1), ov::element::f32);
+        };
 
-        if (keep)
-            picked.push_back(i);
+        // yolox/models/yolo_head.py decode logic
+        auto grid = ov::op::v0::Constant::create(ov::element::f32, ov::Shape{1, anchors, 8}, grids);
+        auto stride = ov::op::v0::Constant::create(ov::element::f32, ov::Shape{1, anchors, 1}, geometry.grid_stride);
+        auto grid_apex = std::make_shared<ov::op::v1::Add>(slice(0, 8), grid);
+        auto apex = std::make_shared<ov::op::v1::Multiply>(grid_apex, stride);
+
+        // 低于阈值的候选置信度置为-1
+        auto objectness = slice(8, 9);
+        auto pass = std::make_shared<ov::op::v1::GreaterEqual>(objectness, scalar(ov::element::f32, BBOX_CONF_THRESH));
+        auto score = std::make_shared<ov::op::v1::Select>(pass, objectness, scalar(ov::element::f32, -1.0));
+
+        auto decoded = std::make_shared<ov::op::v0::Concat>(
+            ov::OutputVector{apex, score, argmax(9, 9 + num_colors), argmax(9 + num_colors, dim)}, 2);
+
+        // 按置信度取前TOPK个候选
+        auto flat_score = std::make_shared<ov::op::v0::Squeeze>(score, axis_value(2));
+        auto top = std::make_shared<ov::op::v3::TopK>(flat_score, scalar(ov::element::i64, topk), 1,
+                                                      ov::op::TopKMode::MAX, ov::op::TopKSortType::SORT_VALUES);
+        auto candidates = std::make_shared<ov::op::v8::Gather>(decoded, top->output(1), scalar(ov::element::i64, 1), 1);
+
+        decode_model->add_results({std::make_shared<ov::op::v0::Result>(candidates)});
+        decode_model->remove_result(raw_result);
+        decode_model->validate_nodes_and_infer_types();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << " ERROR: 无法在推理图中追加解码 " << e.what() << std::endl;
+        return false;
     }
+
+    geometry.graph_topk = topk;
+    std::cout << "Graph decode: top " << topk << " of " << geometry.num_anchors << " anchors" << std::endl;
+    return true;
 }
 
 /**
- * @brief Decode outputs.
- * @param prob Original predition output.
- * @param objects Vector of objects predicted.
- * @param img_w Width of Image.
- * @param img_h Height of Image.
+ * @brief Compile the additional input resolutions listed in RESOLUTION_LEVELS.
+ * @return False if a resolution can not be applied to the model.
  */
-static void decodeOutputs(const float *prob, std::vector<ArmorObject> &objects,
-                          Eigen::Matrix<float, 3, 3> &transform_matrix, const int img_w, const int img_h)
+bool ArmorDetector::compileLevels()
 {
-    std::vector<ArmorObject> proposals;
-    std::vector<int> strides = {8, 16, 32};
-    std::vector<GridAndStride> grid_strides;
+    levels.clear();
+    const std::vector<float> &config = detector_config.resolution_levels;
+    for (size_t i = 0; i + 2 < config.size(); i += 3)
+    {
+        ResolutionLevel level;
+        level.max_distance = config[i + 2];
+
+        std::shared_ptr<ov::Model> level_model = model->clone();
+        if (!reshapeInput(level_model, config[i], config[i + 1]) || !readGeometry(level_model, level.net))
+            return false;
+        if (detector_config.graph_decode && !appendGraphDecode(level_model, level.net))
+            return false;
+        level.compiled_model = ie.compile_model(level_model, detector_config.device, compileConfig());
+        levels.push_back(std::move(level));
+    }
 
-    generate_grids_and_stride(INPUT_W, INPUT_H, strides, grid_strides);
-    generateYoloxProposals(grid_strides, prob, transform_matrix, BBOX_CONF_THRESH, proposals);
-    qsort_descent_inplace(proposals);
+    std::sort(levels.begin(), levels.end(),
+              [](const ResolutionLevel &a, const ResolutionLevel &b) { return a.max_distance < b.max_distance; });
+    return true;
+}
 
-    if (proposals.size() >= TOPK)
-        proposals.resize(TOPK);
-    std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, NMS_THRESH);
-    int count = picked.size();
-    objects.resize(count);
+/**
+ * @brief Choose the input resolution of the next frame from the target distance and the latency budget.
+ * @return 0 for the primary network, i for levels[i - 1].
+ */
+int ArmorDetector::selectLevel() const
+{
+    // 丢失目标时使用主网络全图搜索
+    if (levels.empty() || state == LOST)
+        return 0;
 
-    for (int i = 0; i < count; i++)
+    // 按代价从低到高排列：各附加档位依次，主网络最后
+    const int count = levels.size() + 1;
+    auto levelAt = [count](int i) { return i + 1 < count ? i + 1 : 0; };
+
+    // 取能覆盖目标距离的最低分辨率
+    int i = count - 1;
+    if (target_distance > 0)
     {
-        objects[i] = proposals[picked[i]];
+        for (i = 0; i < count - 1; i++)
+        {
+            if (target_distance <= levels[i].max_distance)
+                break;
+        }
     }
+
+    // 超出耗时预算时继续降低分辨率
+    if (detector_config.latency_budget_ms > 0)
+    {
+        while (i > 0 && level_latency[levelAt(i)] > detector_config.latency_budget_ms)
+            i--;
+    }
+    return levelAt(i);
 }
 
-ArmorDetector::ArmorDetector()
+const NetGeometry &ArmorDetector::levelNet(int level) const
 {
+    return level == 0 ? net : levels[level - 1].net;
 }
 
-ArmorDetector::~ArmorDetector()
+ov::InferRequest &ArmorDetector::levelRequest(InferSlot &slot)
 {
+    return slot.level == 0 ? slot.request : slot.level_requests[slot.level - 1];
 }
 
-// TODO:change to your dir
-bool ArmorDetector::initModel(string path)
+/**
+ * @brief Compile the model with letterbox and u8 NHWC -> f32 NCHW conversion built into the graph.
+ * @param frame_w Width of frames that will be fed.
+ * @param frame_h Height of frames that will be fed.
+ */
+void ArmorDetector::compilePreprocessModel(int frame_w, int frame_h)
 {
-    ie.set_property("CPU", ov::enable_profiling(true));
+    LetterboxGeometry geometry(frame_w, frame_h, net.input_w, net.input_h);
+    const int pad_right = net.input_w - geometry.unpad_w - geometry.pad_left;
+    const int pad_bottom = net.input_h - geometry.unpad_h - geometry.pad_top;
+
+    // 相同图像尺寸的PrePostProcessor网络同样在识别器间共享
+    std::ostringstream key;
+    key << model_key << "|ppp " << frame_w << "x" << frame_h;
+    shared_ppp_model = ModelRegistry::instance().acquire<SharedModel>(key.str(), [&]() {
+        ov::preprocess::PrePostProcessor ppp(model->clone());
+        ppp.input()
+            .tensor()
+            .set_element_type(ov::element::u8)
+            .set_layout("NHWC")
+            .set_shape({1, (size_t)frame_h, (size_t)frame_w, 3});
+        ppp.input()
+            .preprocess()
+            .convert_element_type(ov::element::f32)
+            .resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR, geometry.unpad_h, geometry.unpad_w)
+            .custom([=](const ov::Output<ov::Node> &node) {
+                // 与LetterboxKernel一致的居中零填充
+                auto pads_begin = ov::op::v0::Constant::create(ov::element::i64, ov::Shape{4},
+                                                               {0, geometry.pad_top, geometry.pad_left, 0});
+                auto pads_end =
+                    ov::op::v0::Constant::create(ov::element::i64, ov::Shape{4}, {0, pad_bottom, pad_right, 0});
+                auto pad_value = ov::op::v0::Constant::create(ov::element::f32, ov::Shape{}, {0.f});
+                return std::make_shared<ov::op::v1::Pad>(node, pads_begin, pads_end, pad_value,
+                                                         ov::op::PadMode::CONSTANT)
+                    ->output(0);
+            });
+        ppp.input().model().set_layout("NCHW");
+
+        auto shared = std::make_shared<SharedModel>();
+        shared->compiled_model = ie.compile_model(ppp.build(), detector_config.device, compileConfig());
+        return shared;
+    });
+    compiled_model = shared_ppp_model->compiled_model;
+    createInferSlots();
+    ppp_frame_size = cv::Size(frame_w, frame_h);
+}
 
-    model = ie.read_model(path);
+/**
+ * @brief Run WARMUP_ITERATIONS inferences on a blank frame on every infer request.
+ * @param frame_size Size of the frames that will be detected.
+ */
+void ArmorDetector::warmup(cv::Size frame_size)
+{
+    if (detector_config.warmup_iterations <= 0)
+        return;
 
-    compiled_model = ie.compile_model(model, "CPU");
+    auto t1 = std::chrono::steady_clock::now();
+    cv::Mat blank = cv::Mat::zeros(frame_size, bayer.valid() ? CV_8UC1 : CV_8UC3);
+    std::vector<ArmorObject> objects;
 
-    infer_request = compiled_model.create_infer_request();
+    // 推理请求轮流使用，每个请求都需要预热
+    for (int i = 0; i < detector_config.warmup_iterations; i++)
+    {
+        for (int j = 0; j < pipelineDepth(); j++)
+            submit(blank);
+        while (poll(objects))
+            ;
+    }
 
-    // moutput = infer_request.get_output_tensor(0);
+    // 附加分辨率档位只在跟踪时使用，单独预热
+    for (auto &slot : infer_slots)
+        for (auto &request : slot.level_requests)
+            for (int i = 0; i < detector_config.warmup_iterations; i++)
+                request.infer();
+    auto t2 = std::chrono::steady_clock::now();
+    std::cout << "Warm up: " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+}
 
-    return true;
+/**
+ * @brief Compile properties selected by PERFORMANCE_MODE and NUM_STREAMS.
+ */
+ov::AnyMap ArmorDetector::compileConfig() const
+{
+    ov::AnyMap config;
+    if (detector_config.performance_mode == "THROUGHPUT")
+        config.emplace(ov::hint::performance_mode(ov::hint::PerformanceMode::THROUGHPUT));
+    else
+        config.emplace(ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY));
 
-    // // 1.Create Runtime Core
-    // // ov::Core ie;
-    // model = ie.read_model(path);
+    if (detector_config.num_streams > 0)
+        config.emplace(ov::num_streams(ov::streams::Num(detector_config.num_streams)));
 
-    // // 2.Compile the model
-    // ov::CompiledModel compiled_model = ie.compile_model(path, "GPU");
+    // 逐层计时有额外开销，仅在统计模式下开启
+    config.emplace(ov::enable_profiling(detector_config.profiling_frames > 0));
 
-    // // 3.Create inference request
-    // infer_request = compiled_model.create_infer_request();
+    // 编译结果缓存，缩短重启后的初始化时间；按次编译指定，不影响共享同一 ov::Core 的其他网络
+    if (!detector_config.cache_dir.empty())
+        config.emplace(ov::cache_dir(detector_config.cache_dir));
 
-    // // 4.Set inputs
-    // // Get input tensor by index
-    // input_tensor = infer_request.get_input_tensor(0);
-    // // IR v10 works with converted precisions (i64 -> i32)
-    // // auto data = input_tensor.data<int32_t>();
-    // // Fill first data ...
+    // 浮点层的计算精度；INT8模型的量化层由模型决定，其余层使用设备默认精度
+    const std::string &precision = detector_config.inference_precision;
+    if (precision == "FP32")
+        config.emplace(ov::hint::inference_precision(ov::element::f32));
+    else if (precision == "BF16")
+        config.emplace(ov::hint::inference_precision(ov::element::bf16));
+    else if (precision == "FP16")
+        config.emplace(ov::hint::inference_precision(ov::element::f16));
 
-    // return true;
+    return config;
+}
+
+/**
+ * @brief Create the ring of infer requests used by submit() and poll().
+ */
+void ArmorDetector::createInferSlots()
+{
+    int num_requests = detector_config.infer_requests;
+    // 未指定时使用设备推荐的请求数
+    if (num_requests <= 0)
+        num_requests = compiled_model.get_property(ov::optimal_number_of_infer_requests);
+
+    infer_slots.clear();
+    infer_slots.resize(std::max(1, num_requests));
+    for (auto &slot : infer_slots)
+    {
+        slot.request = compiled_model.create_infer_request();
+        bindCallback(slot, slot.request);
+
+        for (auto &level : levels)
+        {
+            slot.level_requests.push_back(level.compiled_model.create_infer_request());
+            bindCallback(slot, slot.level_requests.back());
+        }
+    }
+    slot_head = 0;
+    slots_in_flight = 0;
+}
+
+/**
+ * @brief Mark the slot done once every request submitted with it has finished.
+ */
+void ArmorDetector::bindCallback(InferSlot &slot, ov::InferRequest &request)
+{
+    InferSlot *slot_ptr = &slot;
+    request.set_callback([this, slot_ptr](std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(slot_mutex);
+        if (error)
+            slot_ptr->error = error;
+        if (--slot_ptr->pending == 0)
+        {
+            slot_ptr->done_time = std::chrono::steady_clock::now();
+            slot_ptr->done = true;
+            slot_cv.notify_all();
+        }
+    });
+}
+
+/**
+ * @brief Split the frame into overlapping tiles of equal size.
+ * @param frame_size Size of the frames that will be detected.
+ */
+void ArmorDetector::layoutTiles(cv::Size frame_size)
+{
+    if (frame_size == tile_frame_size)
+        return;
+
+    // 单个轴上等长分块，首尾贴齐图像边缘，其余均匀分布
+    auto split = [this](int length, int input, int count, std::vector<int> &starts) {
+        const int overlap = std::min(detector_config.tile_overlap, input / 2);
+        int tile;
+        if (count <= 0)
+        {
+            // 未指定分块数时按原始分辨率分块
+            tile = std::min(input, length);
+            count = tile >= length ? 1 : (length - overlap + tile - overlap - 1) / (tile - overlap);
+        }
+        else
+        {
+            tile = std::min(length, (length + (count - 1) * overlap + count - 1) / count);
+        }
+
+        starts.clear();
+        for (int i = 0; i < count; i++)
+            starts.push_back(count == 1 ? 0 : (int)((int64_t)i * (length - tile) / (count - 1)));
+        return tile;
+    };
+
+    std::vector<int> xs, ys;
+    const int tile_w = split(frame_size.width, net.input_w, detector_config.tile_cols, xs);
+    const int tile_h = split(frame_size.height, net.input_h, detector_config.tile_rows, ys);
+
+    tile_layout.clear();
+    for (int y : ys)
+        for (int x : xs)
+            tile_layout.emplace_back(x, y, tile_w, tile_h);
+    tile_frame_size = frame_size;
+
+    std::cout << "Tiles: " << xs.size() << "x" << ys.size() << " of " << tile_w << "x" << tile_h << std::endl;
+}
+
+/**
+ * @brief Block until the completion callback of a slot has fired.
+ */
+void ArmorDetector::waitSlot(InferSlot &slot)
+{
+    std::unique_lock<std::mutex> lock(slot_mutex);
+    slot_cv.wait(lock, [&slot] { return slot.done; });
 }
 
 ArmorDetector::ArmorDetector(string path)
@@ -341,7 +1087,31 @@ ArmorDetector::ArmorDetector(string path)
     initModel(path);
 };
 
+ArmorDetector::ArmorDetector(string path, string config_path)
+{
+    readConfig(config_path);
+    initModel(path);
+}
+
 bool ArmorDetector::detect(Mat &src, std::vector<ArmorObject> &objects)
+{
+    // 同步识别：取回此前尚未取回的结果后提交当前帧并等待
+    while (slots_in_flight > 0)
+        poll(objects);
+
+    if (!submit(src))
+        return false;
+
+    poll(objects);
+    return !objects.empty();
+}
+
+/**
+ * @brief Preprocess a frame into a free infer request and start inference without waiting.
+ * @param src Frame to detect. Its buffer is referenced until the result is polled.
+ * @return False if the frame is empty or every infer request is still in flight.
+ */
+bool ArmorDetector::submit(Mat &src)
 {
     if (src.empty())
     {
@@ -349,84 +1119,403 @@ bool ArmorDetector::detect(Mat &src, std::vector<ArmorObject> &objects)
         return false;
     }
 
-    cv::Mat pr_img = scaledResize(src, transfrom_matrix);
+    if (src.type() == CV_8UC1 && (!bayer.valid() || detector_config.use_ov_preprocess))
+    {
+        std::cout << " ERROR: 拜耳原始图像需要先调用 setBayerInput，且不能与 USE_OV_PREPROCESS 同时使用" << std::endl;
+        return false;
+    }
+
+    if (detector_config.use_ov_preprocess && src.size() != ppp_frame_size)
+    {
+        // 图像尺寸变化需要重新编译，丢弃尚未取回的结果
+        for (; slots_in_flight > 0; slots_in_flight--, slot_head = (slot_head + 1) % infer_slots.size())
+            waitSlot(infer_slots[slot_head]);
+        compilePreprocessModel(src.cols, src.rows);
+    }
+
+    if (slots_in_flight == (int)infer_slots.size())
+        return false;
+
 #ifdef SHOW_INPUT
+    Eigen::Matrix<float, 3, 3> show_matrix;
+    cv::Mat pr_img = scaledResize(src, show_matrix, net.input_w, net.input_h);
     namedWindow("network_input", 0);
     imshow("network_input", pr_img);
     waitKey(1);
 #endif // SHOW_INPUT
-    cv::Mat pre;
-    cv::Mat pre_split[3];
-    pr_img.convertTo(pre, CV_32F);
-    cv::split(pre, pre_split);
-    ov::Tensor imgBlob = infer_request.get_input_tensor(0); // just wrap Mat data by Blob::Ptr
-
-    // locked memory holder should be alive all time while access to its buffer happens
-    auto blob_data = imgBlob.data<float_t>();
-
-    auto img_offset = INPUT_W * INPUT_H;
-    // Copy img into blob
-    for (int c = 0; c < 3; c++)
-    {
-        memcpy(blob_data, pre_split[c].data, INPUT_W * INPUT_H * sizeof(float));
-        blob_data += img_offset;
-    }
-
-    //     auto t1 = std::chrono::steady_clock::now();
-    infer_request.start_async();
-    infer_request.wait();
-    //     auto t2 = std::chrono::steady_clock::now();
-    //     cout<<(float)(std::chrono::duration<double,std::milli>(t2 - t1).count())<<endl;
-    // infer_request.GetPerformanceCounts();
-    // -----------------------------------------------------------------------------------------------------
-    // --------------------------- Step 8. Process output----------------
-    // const Blob::Ptr output_blob = infer_request.GetBlob(output_name);
-    // MemoryBlob::CPtr moutput = as<MemoryBlob>(output_blob);
-    ov::Tensor output_tensor = infer_request.get_output_tensor();
-    const float *net_pred = output_tensor.data<float_t>();
-    int img_w = src.cols;
-    int img_h = src.rows;
-
-    decodeOutputs(net_pred, objects, transfrom_matrix, img_w, img_h);
-    for (auto object = objects.begin(); object != objects.end(); ++object)
+    InferSlot &slot = infer_slots[(slot_head + slots_in_flight) % infer_slots.size()];
+
+    if (detector_config.use_ov_preprocess)
     {
-        // 对候选框预测角点进行平均,降低误差
-        if ((*object).pts.size() >= 8)
+        // 原始u8 BGR图像直接作为输入张量，缩放与格式转换在推理图中完成
+        slot.frame = src.isContinuous() ? src : src.clone();
+        slot.request.set_input_tensor(
+            ov::Tensor(ov::element::u8, {1, (size_t)slot.frame.rows, (size_t)slot.frame.cols, 3}, slot.frame.data));
+        slot.transform_matrix = LetterboxGeometry(src.cols, src.rows, net.input_w, net.input_h).transformMatrix();
+        slot.roi = cv::Rect(0, 0, src.cols, src.rows);
+        slot.level = 0;
+    }
+    else
+    {
+        slot.frame = src;
+        slot.level = selectLevel();
+        const NetGeometry &level_net = levelNet(slot.level);
+        slot.roi = selectRoi(src, level_net);
+        float *input = backend ? backend->input() : levelRequest(slot).get_input_tensor(0).data<float_t>();
+
+        // 缩放、填充与通道拆分一次完成，直接写入输入张量
+        preprocess(src(slot.roi), input, level_net.input_w, level_net.input_h, slot.transform_matrix);
+
+        // ROI坐标平移回整幅图像
+        slot.transform_matrix(0, 2) += slot.roi.x;
+        slot.transform_matrix(1, 2) += slot.roi.y;
+    }
+
+    // 按调度每隔若干帧额外对原始分辨率分块推理，与整帧推理并行
+    slot.tiles_in_use = 0;
+    if (detector_config.tile_mode && !detector_config.use_ov_preprocess &&
+        frames_submitted % std::max(1, detector_config.tile_interval) == 0)
+    {
+        layoutTiles(src.size());
+        slot.tiles_in_use = tile_layout.size();
+        slot.tile_rois.assign(tile_layout.begin(), tile_layout.end());
+        slot.tile_transforms.resize(slot.tiles_in_use);
+        while ((int)slot.tile_requests.size() < slot.tiles_in_use)
         {
-            auto N = (*object).pts.size();
-            cv::Point2f pts_final[4];
+            slot.tile_requests.push_back(compiled_model.create_infer_request());
+            bindCallback(slot, slot.tile_requests.back());
+        }
 
-            for (int i = 0; i < N; i++)
+        for (int t = 0; t < slot.tiles_in_use; t++)
+        {
+            const cv::Rect &tile = slot.tile_rois[t];
+            ov::Tensor tileBlob = slot.tile_requests[t].get_input_tensor(0);
+            preprocess(src(tile), tileBlob.data<float_t>(), net.input_w, net.input_h, slot.tile_transforms[t]);
+            slot.tile_transforms[t](0, 2) += tile.x;
+            slot.tile_transforms[t](1, 2) += tile.y;
+        }
+    }
+    frames_submitted++;
+
+    slot.done = false;
+    slot.error = nullptr;
+    slot.pending = 1 + slot.tiles_in_use;
+    slot.submit_time = std::chrono::steady_clock::now();
+    if (backend)
+    {
+        inferBackend(slot);
+    }
+    else
+    {
+        int started = 0;
+        try
+        {
+            levelRequest(slot).start_async();
+            for (started = 1; started < 1 + slot.tiles_in_use; started++)
+                slot.tile_requests[started - 1].start_async();
+        }
+        catch (const std::exception &)
+        {
+            // 未启动的请求不会回调，从待完成数中扣除，已启动的请求完成后槽位照常结束，错误由poll()报告
+            std::lock_guard<std::mutex> lock(slot_mutex);
+            slot.error = std::current_exception();
+            slot.pending -= 1 + slot.tiles_in_use - started;
+            if (slot.pending == 0)
             {
-                pts_final[i % 4] += (*object).pts[i];
+                slot.done_time = std::chrono::steady_clock::now();
+                slot.done = true;
             }
+        }
+    }
+    slots_in_flight++;
 
-            for (int i = 0; i < 4; i++)
+    return true;
+}
+
+/**
+ * @brief Letterbox a BGR frame or demosaic a raw Bayer frame straight into planar float network input.
+ */
+void ArmorDetector::preprocess(const cv::Mat &src, float *input, int input_w, int input_h,
+                               Eigen::Matrix<float, 3, 3> &transform_matrix)
+{
+    if (src.type() == CV_8UC1)
+        bayer.run(src, input, input_w, input_h, transform_matrix);
+    else
+        letterbox.run(src, input, input_w, input_h, transform_matrix);
+}
+
+/**
+ * @brief Accept raw 8-bit Bayer frames (CV_8UC1) in submit() and detect(), skipping the camera ISP.
+ * @param pattern Colors of the top-left 2x2 cell of the sensor read row by row, e.g. "BGGR".
+ * @param gains White balance gains in B, G, R order, applied to the network input and to toBgr().
+ * @return False if the pattern is unknown or USE_OV_PREPROCESS is enabled.
+ */
+bool ArmorDetector::setBayerInput(const std::string &pattern, const cv::Scalar &gains)
+{
+    if (detector_config.use_ov_preprocess)
+    {
+        std::cout << " ERROR: USE_OV_PREPROCESS 只接受BGR图像" << std::endl;
+        return false;
+    }
+    if (!bayer.setFormat(pattern, gains))
+    {
+        std::cout << " ERROR: 未知的拜耳排列 " << pattern << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Full resolution BGR of a frame for display or recording, raw Bayer frames are demosaiced on demand.
+ */
+void ArmorDetector::toBgr(const Mat &src, Mat &bgr) const
+{
+    if (src.type() == CV_8UC1 && bayer.valid())
+        bayer.toBgr(src, bgr);
+    else
+        bgr = src;
+}
+
+/**
+ * @brief Take the result of the oldest in-flight frame, so results come back in submission order.
+ * @param objects Armors detected in that frame.
+ * @param frame Optional output of the frame the result belongs to.
+ * @param block Wait for the oldest frame if its inference has not finished yet.
+ * @return False if no frame is in flight, or the oldest one is not finished and block is false.
+ */
+bool ArmorDetector::poll(std::vector<ArmorObject> &objects, Mat *frame, bool block)
+{
+    if (slots_in_flight == 0)
+        return false;
+
+    InferSlot &slot = infer_slots[slot_head];
+    if (block)
+    {
+        waitSlot(slot);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex);
+        if (!slot.done)
+            return false;
+    }
+
+    if (slot.error)
+    {
+        try
+        {
+            std::rethrow_exception(slot.error);
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << " ERROR: 推理失败 " << e.what() << std::endl;
+        }
+        objects.clear();
+        isFindArmor = 0;
+    }
+    else
+    {
+        decodeObjects(slot, objects);
+
+        // 各档位推理耗时的滑动平均，分块帧耗时不计入
+        if (slot.tiles_in_use == 0)
+        {
+            double latency = std::chrono::duration<double, std::milli>(slot.done_time - slot.submit_time).count();
+            double &average = level_latency[slot.level];
+            average = average > 0 ? average * 0.9 + latency * 0.1 : latency;
+            level_measured[slot.level] = frames_submitted;
+
+            // 因超出预算被跳过的档位不再被测量，过期后清零使其被重新试探一次，单次慢帧不会永久降级
+            for (size_t i = 0; i < level_latency.size(); i++)
+            {
+                if (frames_submitted - level_measured[i] > LATENCY_PROBE_FRAMES)
+                    level_latency[i] = 0;
+            }
+        }
+
+        if (detector_config.profiling_frames > 0)
+            collectProfile(levelRequest(slot));
+    }
+    updateTrack(objects);
+    poll_roi = slot.roi;
+
+    if (frame)
+        *frame = slot.frame;
+    slot.frame.release();
+
+    slot_head = (slot_head + 1) % infer_slots.size();
+    slots_in_flight--;
+
+    return true;
+}
+
+/**
+ * @brief Accumulate per-layer counters and report them every PROFILING_FRAMES frames.
+ */
+void ArmorDetector::collectProfile(ov::InferRequest &request)
+{
+    profiler.add(request.get_profiling_info());
+    if (profiler.frames() < detector_config.profiling_frames)
+        return;
+
+    profiler.report(std::cout);
+    if (!detector_config.profiling_dump.empty() && !profiler.dump(detector_config.profiling_dump))
+        std::cout << " ERROR: 无法写入 " << detector_config.profiling_dump << std::endl;
+    profiler.reset();
+}
+
+/**
+ * @brief Choose the region fed to the network, a window around the predicted armor while tracking.
+ * @param src Frame to detect.
+ * @param level_net Geometry of the network the frame is fed to.
+ * @return The full frame when not tracking, or when the window would not fit the frame or the armor.
+ */
+cv::Rect ArmorDetector::selectRoi(const cv::Mat &src, const NetGeometry &level_net) const
+{
+    const cv::Rect full(0, 0, src.cols, src.rows);
+    if (!detector_config.roi_mode || state == LOST)
+        return full;
+
+    const int roi_w = level_net.input_w * detector_config.roi_scale;
+    const int roi_h = level_net.input_h * detector_config.roi_scale;
+    // 装甲板过近时在窗口内显示不全，此时全图分辨率已经足够
+    if (roi_w >= src.cols || roi_h >= src.rows || armor_object.rect.width > roi_w / 2 ||
+        armor_object.rect.height > roi_h / 2)
+        return full;
+
+    // 匀速外推到本帧：包括丢失的帧与尚未取回结果的帧
+    const float frames_ahead = lost_frames + slots_in_flight + 1;
+    const cv::Point2f predicted = last_armor_center + armor_velocity * frames_ahead;
+
+    int x = cvRound(predicted.x - roi_w / 2.f);
+    int y = cvRound(predicted.y - roi_h / 2.f);
+    x = std::min(std::max(x, 0), src.cols - roi_w);
+    y = std::min(std::max(y, 0), src.rows - roi_h);
+    return cv::Rect(x, y, roi_w, roi_h);
+}
+
+/**
+ * @brief Follow the armor nearest to the previous target and update the tracking state.
+ * @param objects Armors detected in the latest frame.
+ */
+void ArmorDetector::updateTrack(const std::vector<ArmorObject> &objects)
+{
+    if (objects.empty())
+    {
+        if (state == LOST)
+            return;
+
+        // 连续丢失一定帧数后回到全图搜索
+        lost_frames++;
+        state = lost_frames > detector_config.roi_lost_frames ? LOST : FINDING;
+        if (state == LOST)
+            target_distance = 0;
+        return;
+    }
+
+    auto center = [](const ArmorObject &object) {
+        return (object.apex[0] + object.apex[1] + object.apex[2] + object.apex[3]) * 0.25f;
+    };
+
+    // 首次发现时取置信度最高的目标，之后跟随离上一目标最近的装甲板
+    const ArmorObject *target = &objects[0];
+    if (state != LOST)
+    {
+        float min_dist = FLT_MAX;
+        for (const auto &object : objects)
+        {
+            cv::Point2f d = center(object) - last_armor_center;
+            float dist = d.dot(d);
+            if (dist < min_dist)
             {
-                pts_final[i].x = pts_final[i].x / (N / 4);
-                pts_final[i].y = pts_final[i].y / (N / 4);
+                min_dist = dist;
+                target = &object;
             }
+        }
+    }
 
-            (*object).apex[0] = pts_final[0];
-            (*object).apex[1] = pts_final[1];
-            (*object).apex[2] = pts_final[2];
-            (*object).apex[3] = pts_final[3];
+    const cv::Point2f target_center = center(*target);
+    if (state == LOST)
+    {
+        armor_velocity = cv::Point2f(0, 0);
+        state = FIRST;
+    }
+    else
+    {
+        armor_velocity = (target_center - last_armor_center) / (float)(lost_frames + 1);
+        state = SHOOT;
+    }
+    last_armor_center = target_center;
+    armor_object = *target;
+    lost_frames = 0;
+}
+
+/**
+ * @brief Region of the frame the last polled result was inferred on.
+ */
+cv::Rect ArmorDetector::lastRoi() const
+{
+    return poll_roi;
+}
+
+int ArmorDetector::inFlight() const
+{
+    return slots_in_flight;
+}
+
+int ArmorDetector::pipelineDepth() const
+{
+    return infer_slots.size();
+}
+
+/**
+ * @brief Decode the network outputs of a finished slot into armors in image coordinates.
+ * @param slot Finished slot, its full-frame and tile outputs are merged by one NMS pass.
+ * @param objects Armors detected.
+ */
+void ArmorDetector::decodeObjects(InferSlot &slot, std::vector<ArmorObject> &objects)
+{
+    const int img_w = slot.frame.cols;
+    const int img_h = slot.frame.rows;
+
+    proposals.clear();
+    const float *output = backend ? backend->output() : levelRequest(slot).get_output_tensor().data<float_t>();
+    appendProposals(output, levelNet(slot.level), slot.transform_matrix, proposals);
+    for (int t = 0; t < slot.tiles_in_use; t++)
+    {
+        const size_t first = proposals.size();
+        ov::Tensor tile_tensor = slot.tile_requests[t].get_output_tensor();
+        appendProposals(tile_tensor.data<float_t>(), net, slot.tile_transforms[t], proposals);
+        dropTileEdgeProposals(proposals, first, slot.tile_rois[t], img_w, img_h);
+    }
+
+    decodeOutputs(proposals, picked, nms, TOPK * (1 + slot.tiles_in_use), objects, img_w, img_h);
+    for (auto object = objects.begin(); object != objects.end(); ++object)
+    {
+        // 对候选框预测角点进行平均,降低误差
+        if ((*object).vote_count >= 2)
+        {
+            auto N = (*object).vote_count;
+
+            for (int i = 0; i < 4; i++)
+            {
+                (*object).apex[i].x = (*object).vote_sum[i].x / N;
+                (*object).apex[i].y = (*object).vote_sum[i].y / N;
+            }
         }
         (*object).area = (int)(calcTetragonArea((*object).apex));
     }
     if (objects.size() != 0)
     {
         isFindArmor = 1;
-        return true;
     }
     else
     {
         isFindArmor = 0;
-        return false;
     }
 }
 
-void ArmorDetector::display(Mat &image2show, ArmorObject object)
+void ArmorDetector::display(Mat &image2show, const ArmorObject &object)
 {
     // 绘制十字瞄准线
     line(image2show, Point2f(image2show.size().width / 2, 0),
@@ -450,7 +1539,7 @@ void ArmorDetector::display(Mat &image2show, ArmorObject object)
     // 绘制装甲板四点矩形
     for (int i = 0; i < 4; i++)
     {
-        line(image2show, object.pts[i], object.pts[(i + 1) % 4], Scalar(100, 200, 0), 3);
+        line(image2show, object.apex[i], object.apex[(i + 1) % 4], Scalar(100, 200, 0), 3);
     }
 
     // 绘制目标颜色与类别
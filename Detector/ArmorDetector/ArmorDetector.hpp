@@ -3,11 +3,22 @@
 
 #include "../../Utils/general.hpp"
 #include "../../Utils/msg.hpp"
+#include "ArmorObject.hpp"
+#include "InferBackend.hpp"
+#include "InferProfiler.hpp"
+#include "ModelRegistry.hpp"
+#include "NmsEngine.hpp"
+#include "Preprocess.hpp"
+#include "TopK.hpp"
 #include <eigen3/Eigen/Core>
 #include <ie/cpp/ie_cnn_network.h>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 #include <openvino/runtime/compiled_model.hpp>
@@ -29,17 +40,91 @@ enum ArmorState
     SHOOT = 2,  // 持续识别目标
     FINDING = 3 // 丢失目标但在寻找目标
 };
-// tips: 这里灯条四点坐标用数组和容器存储都是一样的内容，只是为了方便代码调用
-struct ArmorObject
+
+// 识别器参数
+struct DetectorConfig
+{
+    std::string backend = "OPENVINO";         // 推理后端 OPENVINO / OPENCV
+    std::string model;                        // 网络模型，为空时使用程序指定的路径
+    std::string device = "CPU";               // 推理设备
+    int input_width = 0;                      // 网络输入宽度，0为模型原始尺寸
+    int input_height = 0;                     // 网络输入高度，0为模型原始尺寸
+    int use_ov_preprocess = 0;                // 由OpenVINO PrePostProcessor完成缩放、填充与格式转换
+    int infer_requests = 1;                   // 同时在推理中的请求数（流水线深度），0为设备推荐值
+    std::string performance_mode = "LATENCY"; // 性能模式 LATENCY / THROUGHPUT
+    int num_streams = 0;                      // 推理流数量，0为自动
+    std::string cache_dir;                    // 编译模型缓存目录，为空时不缓存
+    int enable_mmap = 1;                      // 内存映射方式读取权重
+    int warmup_iterations = 3;                // 进入采集循环前的预热推理次数
+    int num_colors = 4;                       // 颜色类别数，类别数由模型输出维度推得
+    int profiling_frames = 0;                 // 逐层耗时统计窗口帧数，0为关闭
+    std::string profiling_dump;               // 逐层耗时CSV输出路径，为空时只打印
+    int nms_class_aware = 0;                  // 仅抑制颜色与类别相同的候选
+    int roi_mode = 0;                         // 跟踪目标时只在预测位置附近的窗口内推理
+    float roi_scale = 1.f;                    // ROI窗口与网络输入的尺寸比，1为原始分辨率
+    int roi_lost_frames = 5;                  // ROI内连续丢失多少帧后回到全图搜索
+    int tile_mode = 0;                        // 按原始分辨率分块推理，检测远距离小目标
+    int tile_cols = 0;                        // 分块列数，0为按网络输入尺寸自动划分
+    int tile_rows = 0;                        // 分块行数，0为按网络输入尺寸自动划分
+    int tile_overlap = 64;                    // 相邻分块重叠像素
+    int tile_interval = 1;                    // 每隔多少帧进行一次分块推理
+    std::vector<float> resolution_levels;     // 附加输入分辨率档位，每三个数为 宽 高 最大目标距离(m)
+    float latency_budget_ms = 0;              // 跟踪时单帧推理耗时预算，超出时降低分辨率，0为不限制
+    int graph_decode = 0;                     // 在推理图中完成网格解码、置信度阈值与TopK
+    std::string inference_precision;          // 推理精度 FP32 / BF16 / FP16 / INT8，为空时使用设备默认值
+    std::string int8_model;                   // 预先量化的INT8模型，推理精度为INT8时使用
+};
+
+// 网络输入输出结构（由加载的模型读取）
+struct NetGeometry
 {
-    Point2f apex[4];              // 灯条四点坐标（左上点起始逆时针）
-    cv::Rect_<float> rect;        // 灯条四点矩形
-    int cls;                      // 类别 (0:哨兵 1:英雄 2：工程 3、4、5：步兵 6：前哨站 7：基地)
-    int color;                    // 颜色分类 (0:蓝色 1:红色 2:灰色)
-    int area;                     // 矩形面积大小
-    float prob;                   // 分类置信度
-    std::vector<cv::Point2f> pts; // 灯条四点坐标（左上点起始逆时针）
-    int distinguish = 0;          // 装甲板类型 (0:小装甲板 1:大装甲板)
+    int input_w = 416;                       // 网络输入宽度
+    int input_h = 416;                       // 网络输入高度
+    int num_anchors = 0;                     // 输出候选数量
+    int num_colors = 4;                      // 颜色类别数
+    int num_classes = 8;                     // 装甲板类别数
+    std::vector<float> grid_x;               // 各候选对应的网格横坐标
+    std::vector<float> grid_y;               // 各候选对应的网格纵坐标
+    std::vector<float> grid_stride;          // 各候选对应的步长
+    std::vector<int> obj_offsets;            // 各候选置信度在输出中的偏移
+    int graph_topk = 0;                      // 图内解码时输出的候选数量，0为原始输出
+};
+
+// 附加输入分辨率档位（按目标距离切换）
+struct ResolutionLevel
+{
+    NetGeometry net;                  // 该档位的网络结构
+    ov::CompiledModel compiled_model; // 该档位的可执行网络
+    float max_distance = 0;           // 目标距离不超过该值时使用（米）
+};
+
+// 由 ModelRegistry 在配置相同的识别器间共享的网络
+struct SharedModel
+{
+    std::shared_ptr<ov::Model> model;    // 变换后的网络
+    NetGeometry net;                     // 网络结构
+    ov::CompiledModel compiled_model;    // 可执行网络
+    std::vector<ResolutionLevel> levels; // 附加分辨率档位
+};
+
+// 推理请求槽位
+struct InferSlot
+{
+    ov::InferRequest request;                                // 推理请求
+    cv::Mat frame;                                           // 推理中的图像
+    Eigen::Matrix<float, 3, 3> transform_matrix;             // 网络坐标到图像坐标的变换
+    cv::Rect roi;                                            // 送入网络的图像区域
+    std::vector<ov::InferRequest> tile_requests;             // 分块推理请求
+    std::vector<cv::Rect> tile_rois;                         // 各分块在图像中的区域
+    std::vector<Eigen::Matrix<float, 3, 3>> tile_transforms; // 各分块网络坐标到图像坐标的变换
+    int tiles_in_use = 0;                                    // 本帧推理的分块数
+    std::vector<ov::InferRequest> level_requests;            // 各附加分辨率档位的推理请求
+    int level = 0;                                           // 本帧使用的分辨率档位，0为主网络
+    int pending = 0;                                         // 尚未完成的推理请求数
+    std::chrono::steady_clock::time_point submit_time;       // 提交时间
+    std::chrono::steady_clock::time_point done_time;         // 推理完成时间（由回调记录）
+    bool done = false;                                       // 推理完成（由回调置位）
+    std::exception_ptr error;                                // 推理异常
 };
 
 class ArmorDetector
@@ -47,26 +132,90 @@ class ArmorDetector
   public:
     ArmorDetector();
     explicit ArmorDetector(string path);
+    ArmorDetector(string path, string config_path);
     ~ArmorDetector();
     bool detect(Mat &src, std::vector<ArmorObject> &objects);
-    void display(Mat &image2show, ArmorObject object);
+    bool submit(Mat &src);
+    bool poll(std::vector<ArmorObject> &objects, Mat *frame = nullptr, bool block = true);
+    int inFlight() const;
+    int pipelineDepth() const;
+    cv::Rect lastRoi() const;
+    void display(Mat &image2show, const ArmorObject &object);
+    bool readConfig(string config_path);
     bool initModel(string path);
+    void setInputSize(cv::Size size);
+    void setInferencePrecision(const std::string &precision);
+    void setTargetDistance(float distance);
+    bool setBayerInput(const std::string &pattern, const cv::Scalar &gains);
+    void toBgr(const Mat &src, Mat &bgr) const;
+    const ArmorObject &getTarget() const;
+    void warmup(cv::Size frame_size);
     int getArmorType();
     int isFindTarget();
 
     ArmorState state = LOST;
 
   private:
+    std::string modelKey(const std::string &path) const;
+    std::shared_ptr<SharedModel> loadModel(const std::string &path);
+    bool initBackend(const std::string &path);
+    void inferBackend(InferSlot &slot);
+    bool reshapeInput(std::shared_ptr<ov::Model> &reshape_model, int w, int h);
+    bool readGeometry(const std::shared_ptr<ov::Model> &read_model, NetGeometry &geometry);
+    bool buildGeometry(int input_w, int input_h, int num_anchors, int output_dim, NetGeometry &geometry);
+    bool appendGraphDecode(std::shared_ptr<ov::Model> &decode_model, NetGeometry &geometry);
+    bool compileLevels();
+    int selectLevel() const;
+    const NetGeometry &levelNet(int level) const;
+    ov::InferRequest &levelRequest(InferSlot &slot);
+    void compilePreprocessModel(int frame_w, int frame_h);
+    ov::AnyMap compileConfig() const;
+    void createInferSlots();
+    void bindCallback(InferSlot &slot, ov::InferRequest &request);
+    void layoutTiles(cv::Size frame_size);
+    void waitSlot(InferSlot &slot);
+    void collectProfile(ov::InferRequest &request);
+    cv::Rect selectRoi(const cv::Mat &src, const NetGeometry &level_net) const;
+    void updateTrack(const std::vector<ArmorObject> &objects);
+    void preprocess(const cv::Mat &src, float *input, int input_w, int input_h,
+                    Eigen::Matrix<float, 3, 3> &transform_matrix);
+    void decodeObjects(InferSlot &slot, std::vector<ArmorObject> &objects);
+
+    DetectorConfig detector_config;
+    NetGeometry net;
     int isFindArmor = 0;
-    ov::Core ie;
-    std::shared_ptr<ov::Model> model; // 网络
-    ov::CompiledModel compiled_model; // 可执行网络
-    ov::InferRequest infer_request;   // 推理请求
+    ov::Core &ie = ModelRegistry::instance().core(); // 进程内共享，仅在注册表加锁时使用
+    std::string model_key;                           // 网络在注册表中的键
+    std::shared_ptr<SharedModel> shared_model;       // 共享的网络
+    std::shared_ptr<SharedModel> shared_ppp_model;   // 共享的PrePostProcessor网络
+    std::unique_ptr<InferBackend> backend;           // 非OpenVINO原生流水线时的推理后端
+    std::shared_ptr<ov::Model> model;                // 网络
+    ov::CompiledModel compiled_model;                // 可执行网络
+    std::vector<ResolutionLevel> levels;             // 附加分辨率档位（按最大距离升序）
+    std::vector<double> level_latency;               // 各档位推理耗时滑动平均（ms），0为主网络
+    std::vector<int64_t> level_measured;             // 各档位最近一次测量耗时时的已提交帧数
+    float target_distance = 0;                       // 跟踪目标距离（米），0为未知
+    std::vector<InferSlot> infer_slots;              // 推理请求环形队列
+    int slot_head = 0;                               // 最早提交的推理请求
+    int slots_in_flight = 0;                         // 推理中的请求数
+    std::mutex slot_mutex;                           // 保护槽位完成状态
+    std::condition_variable slot_cv;                 // 推理完成通知
+    int64_t frames_submitted = 0;                    // 已提交帧数（分块调度）
+    std::vector<cv::Rect> tile_layout;               // 分块划分
+    cv::Size tile_frame_size;                        // 分块划分对应的图像尺寸
     // ArmorState state;
     ArmorObject armor_object;
     cv::Point2f last_armor_center;
-
-    Eigen::Matrix<float, 3, 3> transfrom_matrix;
+    cv::Point2f armor_velocity;         // 目标中心每帧位移
+    int lost_frames = 0;                // 连续丢失目标的帧数
+    cv::Rect poll_roi;                  // 最近取回结果的推理区域
+    LetterboxKernel letterbox;          // 输入预处理
+    BayerKernel bayer;                  // 拜耳原始图像输入预处理
+    cv::Size ppp_frame_size;            // PrePostProcessor模型对应的输入图像尺寸
+    InferProfiler profiler;             // 逐层耗时统计
+    std::vector<ArmorObject> proposals; // 解码候选（复用内存）
+    std::vector<int> picked;            // NMS保留的候选（复用内存）
+    NmsEngine nms;                      // 非极大值抑制
 };
 
 } // namespace armor_detector
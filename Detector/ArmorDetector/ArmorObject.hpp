@@ -0,0 +1,47 @@
+#ifndef YOLOXARMOR_ARMOR_OBJECT_H
+#define YOLOXARMOR_ARMOR_OBJECT_H
+
+#include <opencv2/core/types.hpp>
+#include <type_traits>
+
+namespace armor_detector
+{
+
+// tips: 识别结果为定长结构体，可直接按值拷贝，解码与NMS过程中不进行堆内存分配
+struct ArmorObject
+{
+    cv::Point2f apex[4];     // 灯条四点坐标（左上点起始逆时针）
+    cv::Rect_<float> rect;   // 灯条四点矩形
+    int cls;                 // 类别 (0:哨兵 1:英雄 2：工程 3、4、5：步兵 6：前哨站 7：基地)
+    int color;               // 颜色分类 (0:蓝色 1:红色 2:灰色)
+    int area;                // 矩形面积大小
+    float prob;              // 分类置信度
+    cv::Point2f vote_sum[4]; // 参与角点平均的四点坐标累加（含自身）
+    int vote_count = 0;      // 参与角点平均的候选数
+    int distinguish = 0;     // 装甲板类型 (0:小装甲板 1:大装甲板)
+
+    /**
+     * @brief Add the corners of a duplicate proposal to the corner vote.
+     */
+    inline void vote(const cv::Point2f pts[4])
+    {
+        for (int i = 0; i < 4; i++)
+            vote_sum[i] += pts[i];
+        vote_count++;
+    }
+};
+
+static_assert(std::is_trivially_copyable<ArmorObject>::value, "ArmorObject must stay trivially copyable");
+
+/**
+ * @brief Armor size of a class, heroes and bases carry large armors.
+ * @return 0 for small armors, 1 for large armors, same as ArmorObject::distinguish.
+ */
+inline int armorSize(int cls)
+{
+    return cls == 1 || cls == 7 ? 1 : 0;
+}
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_ARMOR_OBJECT_H
@@ -0,0 +1,169 @@
+#include "InferBackend.hpp"
+#include "ModelRegistry.hpp"
+#include <iostream>
+#include <sstream>
+
+using namespace armor_detector;
+
+OpenVinoBackend::OpenVinoBackend(const std::string &_device) : device(_device)
+{
+}
+
+std::string OpenVinoBackend::name() const
+{
+    return "OPENVINO";
+}
+
+bool OpenVinoBackend::load(const std::string &path, int input_w, int input_h)
+{
+    std::ostringstream key;
+    key << "backend|" << path << "|" << device << "|" << input_w << "x" << input_h;
+    try
+    {
+        compiled_model = ModelRegistry::instance().acquire<ov::CompiledModel>(key.str(), [&]() {
+            ov::Core &core = ModelRegistry::instance().core();
+            std::shared_ptr<ov::Model> model = core.read_model(path);
+            if (input_w > 0 && input_h > 0)
+                model->reshape(ov::PartialShape{1, 3, input_h, input_w});
+            return std::make_shared<ov::CompiledModel>(core.compile_model(
+                model, device, ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY)));
+        });
+        request = compiled_model->create_infer_request();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << " ERROR: OpenVINO 无法加载模型 " << path << " " << e.what() << std::endl;
+        return false;
+    }
+
+    const ov::Shape input_shape = compiled_model->input().get_shape();   // N C H W
+    const ov::Shape output_shape = compiled_model->output().get_shape(); // N anchors (9 + colors + classes)
+    if (input_shape.size() != 4 || output_shape.size() != 3)
+    {
+        std::cout << " ERROR: 不支持的模型输入输出 " << input_shape << " -> " << output_shape << std::endl;
+        return false;
+    }
+    input_size = cv::Size(input_shape[3], input_shape[2]);
+    num_anchors = output_shape[1];
+    output_dim = output_shape[2];
+    return true;
+}
+
+cv::Size OpenVinoBackend::inputSize() const
+{
+    return input_size;
+}
+
+int OpenVinoBackend::numAnchors() const
+{
+    return num_anchors;
+}
+
+int OpenVinoBackend::outputDim() const
+{
+    return output_dim;
+}
+
+float *OpenVinoBackend::input()
+{
+    return request.get_input_tensor().data<float>();
+}
+
+void OpenVinoBackend::infer()
+{
+    request.infer();
+}
+
+const float *OpenVinoBackend::output()
+{
+    return request.get_output_tensor().data<float>();
+}
+
+std::string OpenCvDnnBackend::name() const
+{
+    return "OPENCV";
+}
+
+bool OpenCvDnnBackend::load(const std::string &path, int input_w, int input_h)
+{
+    // OpenCV DNN 不提供模型的输入尺寸，未指定时使用 416x416
+    const int w = input_w > 0 ? input_w : 416;
+    const int h = input_h > 0 ? input_h : 416;
+
+    // IR 模型只能由带 OpenVINO 的 OpenCV 读取，且无法切换到 DNN_BACKEND_OPENCV，此后端只接受 ONNX
+    const size_t ext = path.find_last_of('.');
+    if (ext == std::string::npos || path.substr(ext) != ".onnx")
+    {
+        std::cout << " ERROR: OpenCV DNN 后端只支持 ONNX 模型，请在 MODEL 中指定 .onnx 文件: " << path << std::endl;
+        return false;
+    }
+
+    try
+    {
+        dnn_net = cv::dnn::readNetFromONNX(path);
+        dnn_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        dnn_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+
+        const int shape[] = {1, 3, h, w};
+        blob.create(4, shape, CV_32F);
+        blob.setTo(0);
+        // 空白输入推理一次，得到输出形状
+        infer();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << " ERROR: OpenCV DNN 无法加载模型 " << path << " " << e.what() << std::endl;
+        return false;
+    }
+
+    if (out.dims != 3)
+    {
+        std::cout << " ERROR: 不支持的模型输出维度 " << out.dims << std::endl;
+        return false;
+    }
+    num_anchors = out.size[1];
+    output_dim = out.size[2];
+    return true;
+}
+
+cv::Size OpenCvDnnBackend::inputSize() const
+{
+    return cv::Size(blob.size[3], blob.size[2]);
+}
+
+int OpenCvDnnBackend::numAnchors() const
+{
+    return num_anchors;
+}
+
+int OpenCvDnnBackend::outputDim() const
+{
+    return output_dim;
+}
+
+float *OpenCvDnnBackend::input()
+{
+    return blob.ptr<float>();
+}
+
+void OpenCvDnnBackend::infer()
+{
+    dnn_net.setInput(blob);
+    dnn_net.forward(out);
+}
+
+const float *OpenCvDnnBackend::output()
+{
+    return out.ptr<float>();
+}
+
+std::unique_ptr<InferBackend> armor_detector::createInferBackend(const std::string &name, const std::string &device)
+{
+    if (name == "OPENVINO")
+        return std::unique_ptr<InferBackend>(new OpenVinoBackend(device));
+    if (name == "OPENCV")
+        return std::unique_ptr<InferBackend>(new OpenCvDnnBackend());
+
+    std::cout << " ERROR: 未知的推理后端 " << name << std::endl;
+    return nullptr;
+}
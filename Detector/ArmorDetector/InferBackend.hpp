@@ -0,0 +1,125 @@
+#ifndef YOLOXARMOR_INFER_BACKEND_H
+#define YOLOXARMOR_INFER_BACKEND_H
+
+#include <memory>
+#include <string>
+
+#include <opencv2/dnn.hpp>
+#include <opencv2/opencv.hpp>
+#include <openvino/openvino.hpp>
+
+namespace armor_detector
+{
+
+/**
+ * @brief 推理后端
+ *
+ * 以同步方式完成单帧推理：输入为网络尺寸的 NCHW float 缓冲区（由 LetterboxKernel 直接写入），输出为
+ * [候选数, 9 + 颜色数 + 类别数] 的原始网络输出。ArmorDetector 的异步流水线、分辨率档位、分块推理、
+ * 图内预处理与图内解码依赖 OpenVINO 原生接口，只在 BACKEND 为 OPENVINO 时可用。
+ */
+class InferBackend
+{
+  public:
+    virtual ~InferBackend() = default;
+
+    /**
+     * @brief Name used in the BACKEND config item.
+     */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Load the model.
+     * @param path Model file, IR (.xml) or ONNX (.onnx) for OpenVINO, ONNX only for OpenCV DNN.
+     * @param input_w Network input width, 0 keeps the size of the model.
+     * @param input_h Network input height, 0 keeps the size of the model.
+     * @return False if the model can not be loaded.
+     */
+    virtual bool load(const std::string &path, int input_w, int input_h) = 0;
+
+    /**
+     * @brief Network input size.
+     */
+    virtual cv::Size inputSize() const = 0;
+
+    /**
+     * @brief Number of anchors in the output.
+     */
+    virtual int numAnchors() const = 0;
+
+    /**
+     * @brief Number of values per anchor in the output.
+     */
+    virtual int outputDim() const = 0;
+
+    /**
+     * @brief Input buffer, 1 x 3 x H x W floats.
+     */
+    virtual float *input() = 0;
+
+    /**
+     * @brief Run inference on the input buffer, throws on failure.
+     */
+    virtual void infer() = 0;
+
+    /**
+     * @brief Output of the last inference, numAnchors() x outputDim() floats.
+     */
+    virtual const float *output() = 0;
+};
+
+// OpenVINO 同步推理，编译结果经 ModelRegistry 共享
+class OpenVinoBackend : public InferBackend
+{
+  public:
+    explicit OpenVinoBackend(const std::string &device);
+    std::string name() const override;
+    bool load(const std::string &path, int input_w, int input_h) override;
+    cv::Size inputSize() const override;
+    int numAnchors() const override;
+    int outputDim() const override;
+    float *input() override;
+    void infer() override;
+    const float *output() override;
+
+  private:
+    std::string device;                                // 推理设备
+    std::shared_ptr<ov::CompiledModel> compiled_model; // 共享的可执行网络
+    ov::InferRequest request;                          // 推理请求
+    cv::Size input_size;                               // 网络输入尺寸
+    int num_anchors = 0;                               // 输出候选数量
+    int output_dim = 0;                                // 每个候选的输出长度
+};
+
+// OpenCV DNN 推理（CPU，仅ONNX模型）
+class OpenCvDnnBackend : public InferBackend
+{
+  public:
+    std::string name() const override;
+    bool load(const std::string &path, int input_w, int input_h) override;
+    cv::Size inputSize() const override;
+    int numAnchors() const override;
+    int outputDim() const override;
+    float *input() override;
+    void infer() override;
+    const float *output() override;
+
+  private:
+    cv::dnn::Net dnn_net; // 网络
+    cv::Mat blob;         // 输入 1 x 3 x H x W
+    cv::Mat out;          // 输出 1 x 候选数 x 输出长度
+    int num_anchors = 0;  // 输出候选数量
+    int output_dim = 0;   // 每个候选的输出长度
+};
+
+/**
+ * @brief Create a backend by name.
+ * @param name OPENVINO or OPENCV.
+ * @param device OpenVINO device, ignored by the other backends.
+ * @return Nullptr if the name is unknown.
+ */
+std::unique_ptr<InferBackend> createInferBackend(const std::string &name, const std::string &device);
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_INFER_BACKEND_H
@@ -0,0 +1,122 @@
+#include "InferProfiler.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+
+using namespace armor_detector;
+
+void InferProfiler::add(const std::vector<ov::ProfilingInfo> &infos)
+{
+    std::map<std::string, double> type_time;
+    for (const auto &info : infos)
+    {
+        if (info.status != ov::ProfilingInfo::Status::EXECUTED)
+            continue;
+
+        const double us = info.real_time.count();
+        LayerStats &layer = layers[info.node_name];
+        layer.node_type = info.node_type;
+        layer.exec_type = info.exec_type;
+        layer.time_us.push_back(us);
+
+        type_time[info.node_type + " / " + info.exec_type] += us;
+    }
+
+    for (const auto &t : type_time)
+        types[t.first].time_us.push_back(t.second);
+
+    num_frames++;
+}
+
+int InferProfiler::frames() const
+{
+    return num_frames;
+}
+
+void InferProfiler::reset()
+{
+    num_frames = 0;
+    layers.clear();
+    types.clear();
+}
+
+InferProfiler::Summary InferProfiler::summarize(const std::string &name, const LayerStats &stats)
+{
+    Summary summary{name, stats.node_type, stats.exec_type, 0.0, 0.0};
+    if (stats.time_us.empty())
+        return summary;
+
+    std::vector<double> sorted = stats.time_us;
+    summary.mean_us = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+    size_t p99 = std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.99));
+    std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+    summary.p99_us = sorted[p99];
+    return summary;
+}
+
+std::vector<InferProfiler::Summary> InferProfiler::layerSummaries() const
+{
+    std::vector<Summary> summaries;
+    for (const auto &layer : layers)
+        summaries.push_back(summarize(layer.first, layer.second));
+
+    std::sort(summaries.begin(), summaries.end(),
+              [](const Summary &a, const Summary &b) { return a.mean_us > b.mean_us; });
+    return summaries;
+}
+
+std::vector<InferProfiler::Summary> InferProfiler::typeSummaries() const
+{
+    std::vector<Summary> summaries;
+    for (const auto &type : types)
+        summaries.push_back(summarize(type.first, type.second));
+
+    std::sort(summaries.begin(), summaries.end(),
+              [](const Summary &a, const Summary &b) { return a.mean_us > b.mean_us; });
+    return summaries;
+}
+
+void InferProfiler::report(std::ostream &os) const
+{
+    const std::vector<Summary> by_type = typeSummaries();
+    const std::vector<Summary> by_layer = layerSummaries();
+
+    double total_us = 0;
+    for (const auto &type : by_type)
+        total_us += type.mean_us;
+
+    os << "===== Inference profile over " << num_frames << " frames, " << std::fixed << std::setprecision(1)
+       << total_us / 1000.0 << " ms/frame =====" << std::endl;
+
+    os << "-- By primitive type --" << std::endl;
+    os << std::setw(10) << "mean(us)" << std::setw(10) << "p99(us)" << std::setw(8) << "share"
+       << "  type / implementation" << std::endl;
+    for (const auto &type : by_type)
+        os << std::setw(10) << type.mean_us << std::setw(10) << type.p99_us << std::setw(7)
+           << (total_us > 0 ? 100.0 * type.mean_us / total_us : 0.0) << "%  " << type.name << std::endl;
+
+    // 只打印最慢的层，完整数据使用dump导出
+    os << "-- Slowest layers --" << std::endl;
+    os << std::setw(10) << "mean(us)" << std::setw(10) << "p99(us)"
+       << "  layer (type / implementation)" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(by_layer.size(), 20); i++)
+        os << std::setw(10) << by_layer[i].mean_us << std::setw(10) << by_layer[i].p99_us << "  " << by_layer[i].name
+           << " (" << by_layer[i].node_type << " / " << by_layer[i].exec_type << ")" << std::endl;
+
+    os.unsetf(std::ios::fixed);
+}
+
+bool InferProfiler::dump(const std::string &path) const
+{
+    std::ofstream ofs(path);
+    if (!ofs.is_open())
+        return false;
+
+    ofs << "layer,node_type,exec_type,mean_us,p99_us" << std::endl;
+    for (const auto &layer : layerSummaries())
+        ofs << layer.name << "," << layer.node_type << "," << layer.exec_type << "," << layer.mean_us << ","
+            << layer.p99_us << std::endl;
+    return true;
+}
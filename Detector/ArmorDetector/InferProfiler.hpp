@@ -0,0 +1,74 @@
+#ifndef YOLOXARMOR_INFER_PROFILER_H
+#define YOLOXARMOR_INFER_PROFILER_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <openvino/runtime/profiling_info.hpp>
+
+namespace armor_detector
+{
+
+/**
+ * @brief 逐层推理耗时统计
+ *
+ * 在若干帧内收集 InferRequest::get_profiling_info 的结果，按层与按算子类型汇总均值与p99耗时，
+ * 用于定位可以裁剪或量化的网络层。
+ */
+class InferProfiler
+{
+  public:
+    /**
+     * @brief Add the per-layer counters of one inference.
+     */
+    void add(const std::vector<ov::ProfilingInfo> &infos);
+
+    /**
+     * @brief Number of inferences collected since the last reset.
+     */
+    int frames() const;
+
+    /**
+     * @brief Print per-layer and per-type mean/p99 real time, slowest first.
+     */
+    void report(std::ostream &os) const;
+
+    /**
+     * @brief Write per-layer statistics as CSV.
+     * @return False if the file could not be opened.
+     */
+    bool dump(const std::string &path) const;
+
+    void reset();
+
+  private:
+    struct LayerStats
+    {
+        std::string node_type;       // 原始算子类型
+        std::string exec_type;       // 实际执行的内核实现
+        std::vector<double> time_us; // 每帧耗时
+    };
+
+    struct Summary
+    {
+        std::string name;
+        std::string node_type;
+        std::string exec_type;
+        double mean_us;
+        double p99_us;
+    };
+
+    static Summary summarize(const std::string &name, const LayerStats &stats);
+    std::vector<Summary> layerSummaries() const;
+    std::vector<Summary> typeSummaries() const;
+
+    int num_frames = 0;
+    std::map<std::string, LayerStats> layers; // 按层统计
+    std::map<std::string, LayerStats> types;  // 按算子类型统计（每帧内求和）
+};
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_INFER_PROFILER_H
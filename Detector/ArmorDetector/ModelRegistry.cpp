@@ -0,0 +1,14 @@
+#include "ModelRegistry.hpp"
+
+using namespace armor_detector;
+
+ModelRegistry &ModelRegistry::instance()
+{
+    static ModelRegistry registry;
+    return registry;
+}
+
+ov::Core &ModelRegistry::core()
+{
+    return ie;
+}
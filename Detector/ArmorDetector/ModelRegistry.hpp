@@ -0,0 +1,67 @@
+#ifndef YOLOXARMOR_MODEL_REGISTRY_H
+#define YOLOXARMOR_MODEL_REGISTRY_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <openvino/openvino.hpp>
+
+namespace armor_detector
+{
+
+/**
+ * @brief 进程内共享的模型注册表
+ *
+ * 所有识别器共用同一个 ov::Core；读取、变换并编译后的网络按 模型路径 + 编译配置 登记，配置相同的识别器
+ * 共享同一份权重与可执行网络，各自只创建自己的推理请求。最后一个持有者释放后网络随之释放。
+ */
+class ModelRegistry
+{
+  public:
+    static ModelRegistry &instance();
+
+    /**
+     * @brief Core shared by all detectors, only use it inside a build function of acquire().
+     * Pass per-model options such as ov::cache_dir to read_model() / compile_model() instead of set_property().
+     */
+    ov::Core &core();
+
+    /**
+     * @brief Get the entry registered under key, build and register it if there is none alive.
+     * @param key Model path and every config item that changes the compiled network.
+     * @param build Called with the registry locked, returns nullptr on failure.
+     * @return Shared entry, nullptr if build failed.
+     */
+    template <typename T>
+    std::shared_ptr<T> acquire(const std::string &key, const std::function<std::shared_ptr<T>()> &build)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.find(key);
+        if (entry != entries.end())
+        {
+            if (std::shared_ptr<void> alive = entry->second.lock())
+                return std::static_pointer_cast<T>(alive);
+        }
+
+        std::shared_ptr<T> built = build();
+        if (built)
+            entries[key] = built;
+        return built;
+    }
+
+  private:
+    ModelRegistry() = default;
+    ModelRegistry(const ModelRegistry &) = delete;
+    ModelRegistry &operator=(const ModelRegistry &) = delete;
+
+    std::mutex mutex;                                   // 串行化编译与登记
+    ov::Core ie;                                        // 共享的推理核心
+    std::map<std::string, std::weak_ptr<void>> entries; // 已登记的网络
+};
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_MODEL_REGISTRY_H
@@ -0,0 +1,228 @@
+#include "NmsEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <opencv2/core/hal/intrin.hpp>
+
+using namespace armor_detector;
+
+// 网格边长取2的幂，登记与判定所在网格时没有舍入误差
+static constexpr int CELL_SIZE = 64;
+static constexpr float INV_CELL_SIZE = 1.f / CELL_SIZE;
+
+void NmsEngine::Cell::clear()
+{
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+    area.clear();
+    index.clear();
+}
+
+void NmsEngine::setThreshold(float _nms_threshold)
+{
+    nms_threshold = _nms_threshold;
+}
+
+void NmsEngine::setVoting(float min_iou, float conf_error)
+{
+    vote_min_iou = min_iou;
+    vote_conf_error = conf_error;
+}
+
+void NmsEngine::setClassAware(bool _class_aware)
+{
+    class_aware = _class_aware;
+}
+
+void NmsEngine::resizeGrid(int img_w, int img_h)
+{
+    const int w = std::max(1, (img_w + CELL_SIZE - 1) / CELL_SIZE);
+    const int h = std::max(1, (img_h + CELL_SIZE - 1) / CELL_SIZE);
+    if (w == grid_w && h == grid_h)
+        return;
+
+    grid_w = w;
+    grid_h = h;
+    cells.clear();
+    touched_cells.clear();
+    bucket_keys.clear();
+}
+
+/**
+ * @brief Find or create the bucket of the proposal, all proposals share bucket 0 unless class aware.
+ */
+int NmsEngine::bucketOf(const ArmorObject &object)
+{
+    if (!class_aware)
+        return 0;
+
+    const std::pair<int, int> key(object.color, object.cls);
+    for (int b = 0; b < (int)bucket_keys.size(); b++)
+    {
+        if (bucket_keys[b] == key)
+            return b;
+    }
+    bucket_keys.push_back(key);
+    return bucket_keys.size() - 1;
+}
+
+/**
+ * @brief Range of grid cells covered by the proposal, boxes outside the image are clamped to the border cells.
+ */
+void NmsEngine::cellRange(const ArmorObject &object, int &cx0, int &cy0, int &cx1, int &cy1) const
+{
+    cx0 = std::min(std::max(cvFloor(object.rect.x * INV_CELL_SIZE), 0), grid_w - 1);
+    cy0 = std::min(std::max(cvFloor(object.rect.y * INV_CELL_SIZE), 0), grid_h - 1);
+    cx1 = std::min(std::max(cvFloor((object.rect.x + object.rect.width) * INV_CELL_SIZE), 0), grid_w - 1);
+    cy1 = std::min(std::max(cvFloor((object.rect.y + object.rect.height) * INV_CELL_SIZE), 0), grid_h - 1);
+}
+
+void NmsEngine::insert(const ArmorObject &object, int i, int bucket)
+{
+    int cx0, cy0, cx1, cy1;
+    cellRange(object, cx0, cy0, cx1, cy1);
+
+    const size_t cells_needed = (size_t)(bucket + 1) * grid_w * grid_h;
+    if (cells.size() < cells_needed)
+        cells.resize(cells_needed);
+
+    for (int cy = cy0; cy <= cy1; cy++)
+    {
+        for (int cx = cx0; cx <= cx1; cx++)
+        {
+            const int cell_idx = (bucket * grid_h + cy) * grid_w + cx;
+            Cell &cell = cells[cell_idx];
+            if (cell.index.empty())
+                touched_cells.push_back(cell_idx);
+            cell.x1.push_back(object.rect.x);
+            cell.y1.push_back(object.rect.y);
+            cell.x2.push_back(object.rect.x + object.rect.width);
+            cell.y2.push_back(object.rect.y + object.rect.height);
+            cell.area.push_back(object.rect.area());
+            cell.index.push_back(i);
+        }
+    }
+}
+
+/**
+ * @brief Compare proposal i against the kept proposals of its bucket and cast its corner votes.
+ * @return True if the proposal is suppressed.
+ */
+bool NmsEngine::suppress(std::vector<ArmorObject> &objects, int i, int bucket)
+{
+    const ArmorObject &a = objects[i];
+    if ((size_t)(bucket + 1) * grid_w * grid_h > cells.size())
+        return false;
+
+    const float ax1 = a.rect.x;
+    const float ay1 = a.rect.y;
+    const float ax2 = a.rect.x + a.rect.width;
+    const float ay2 = a.rect.y + a.rect.height;
+    const float a_area = a.rect.area();
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // 与重复框的投票条件与原逐对比较一致
+    auto vote = [&](int j, float iou) {
+        ArmorObject &b = objects[j];
+        if (iou > vote_min_iou && std::abs(a.prob - b.prob) < vote_conf_error && a.cls == b.cls &&
+            a.color == b.color)
+            b.vote(a.apex);
+    };
+
+    int cx0, cy0, cx1, cy1;
+    cellRange(a, cx0, cy0, cx1, cy1);
+
+#if CV_SIMD
+    const int VECSZ = CV_SIMD_WIDTH / sizeof(float);
+    const cv::v_float32 v_ax1 = cv::vx_setall_f32(ax1), v_ay1 = cv::vx_setall_f32(ay1);
+    const cv::v_float32 v_ax2 = cv::vx_setall_f32(ax2), v_ay2 = cv::vx_setall_f32(ay2);
+    const cv::v_float32 v_area = cv::vx_setall_f32(a_area);
+    const cv::v_float32 v_thresh = cv::vx_setall_f32(nms_threshold);
+    const cv::v_float32 v_zero = cv::vx_setzero_f32();
+    float iou_buf[CV_SIMD_WIDTH / sizeof(float)];
+#endif
+
+    bool suppressed = false;
+    for (int cy = cy0; cy <= cy1; cy++)
+    {
+        // 边缘网格延伸到无穷远，与cellRange的截断保持一致
+        const float lo_y = cy == 0 ? -inf : cy * CELL_SIZE;
+        const float hi_y = cy == grid_h - 1 ? inf : (cy + 1) * CELL_SIZE;
+        for (int cx = cx0; cx <= cx1; cx++)
+        {
+            const float lo_x = cx == 0 ? -inf : cx * CELL_SIZE;
+            const float hi_x = cx == grid_w - 1 ? inf : (cx + 1) * CELL_SIZE;
+
+            const Cell &cell = cells[(bucket * grid_h + cy) * grid_w + cx];
+            const int n = cell.index.size();
+            int j = 0;
+#if CV_SIMD
+            const cv::v_float32 v_lo_x = cv::vx_setall_f32(lo_x), v_hi_x = cv::vx_setall_f32(hi_x);
+            const cv::v_float32 v_lo_y = cv::vx_setall_f32(lo_y), v_hi_y = cv::vx_setall_f32(hi_y);
+            for (; j <= n - VECSZ; j += VECSZ)
+            {
+                cv::v_float32 ix1 = cv::v_max(cv::vx_load(cell.x1.data() + j), v_ax1);
+                cv::v_float32 iy1 = cv::v_max(cv::vx_load(cell.y1.data() + j), v_ay1);
+                cv::v_float32 ix2 = cv::v_min(cv::vx_load(cell.x2.data() + j), v_ax2);
+                cv::v_float32 iy2 = cv::v_min(cv::vx_load(cell.y2.data() + j), v_ay2);
+                cv::v_float32 inter = cv::v_max(ix2 - ix1, v_zero) * cv::v_max(iy2 - iy1, v_zero);
+                cv::v_float32 iou = inter / (v_area + cv::vx_load(cell.area.data() + j) - inter);
+
+                // 只在交集左上角所在的网格中计数
+                cv::v_float32 mask = (iou > v_thresh) & (ix1 >= v_lo_x) & (ix1 < v_hi_x) & (iy1 >= v_lo_y) &
+                                     (iy1 < v_hi_y);
+                int lanes = cv::v_signmask(mask);
+                if (!lanes)
+                    continue;
+
+                suppressed = true;
+                cv::v_store(iou_buf, iou);
+                for (int k = 0; k < VECSZ; k++)
+                {
+                    if (lanes & (1 << k))
+                        vote(cell.index[j + k], iou_buf[k]);
+                }
+            }
+#endif
+            for (; j < n; j++)
+            {
+                float ix1 = std::max(cell.x1[j], ax1);
+                float iy1 = std::max(cell.y1[j], ay1);
+                float ix2 = std::min(cell.x2[j], ax2);
+                float iy2 = std::min(cell.y2[j], ay2);
+                float inter = std::max(ix2 - ix1, 0.f) * std::max(iy2 - iy1, 0.f);
+                float iou = inter / (a_area + cell.area[j] - inter);
+                if (iou > nms_threshold && ix1 >= lo_x && ix1 < hi_x && iy1 >= lo_y && iy1 < hi_y)
+                {
+                    suppressed = true;
+                    vote(cell.index[j], iou);
+                }
+            }
+        }
+    }
+    return suppressed;
+}
+
+void NmsEngine::run(std::vector<ArmorObject> &objects, std::vector<int> &picked, int img_w, int img_h)
+{
+    picked.clear();
+    resizeGrid(img_w, img_h);
+
+    for (int cell_idx : touched_cells)
+        cells[cell_idx].clear();
+    touched_cells.clear();
+    bucket_keys.clear();
+
+    const int n = objects.size();
+    for (int i = 0; i < n; i++)
+    {
+        const int bucket = bucketOf(objects[i]);
+        if (suppress(objects, i, bucket))
+            continue;
+
+        insert(objects[i], i, bucket);
+        picked.push_back(i);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef YOLOXARMOR_NMS_ENGINE_H
+#define YOLOXARMOR_NMS_ENGINE_H
+
+#include "ArmorObject.hpp"
+#include <utility>
+#include <vector>
+
+namespace armor_detector
+{
+
+/**
+ * @brief 基于粗网格索引的非极大值抑制
+ *
+ * 已保留的候选按 (颜色, 类别) 分桶，并以SoA形式登记到其覆盖的每个网格中；新候选只与所覆盖网格内的
+ * 已保留候选做向量化IoU计算，相距较远的候选对不再比较。每对候选只在其交集左上角所在的网格中
+ * 计算一次，保证角点投票不会重复累加。
+ */
+class NmsEngine
+{
+  public:
+    /**
+     * @brief Set the IoU above which a proposal is suppressed.
+     */
+    void setThreshold(float nms_threshold);
+
+    /**
+     * @brief Set the condition under which a suppressed proposal votes for the corners of the kept one.
+     * @param min_iou IoU above which the proposals are treated as duplicates.
+     * @param conf_error Maximum confidence difference of duplicates.
+     */
+    void setVoting(float min_iou, float conf_error);
+
+    /**
+     * @brief Only suppress proposals of the same color and class.
+     */
+    void setClassAware(bool class_aware);
+
+    /**
+     * @brief Non-maximum suppression with corner voting.
+     * @param objects Proposals sorted by descending confidence, kept ones receive the corner votes.
+     * @param picked Indices of the kept proposals.
+     * @param img_w Width of the image the proposals are in.
+     * @param img_h Height of the image the proposals are in.
+     */
+    void run(std::vector<ArmorObject> &objects, std::vector<int> &picked, int img_w, int img_h);
+
+  private:
+    // 网格内已保留候选（SoA）
+    struct Cell
+    {
+        std::vector<float> x1;
+        std::vector<float> y1;
+        std::vector<float> x2;
+        std::vector<float> y2;
+        std::vector<float> area;
+        std::vector<int> index; // 在候选数组中的下标
+
+        void clear();
+    };
+
+    void resizeGrid(int img_w, int img_h);
+    int bucketOf(const ArmorObject &object);
+    bool suppress(std::vector<ArmorObject> &objects, int i, int bucket);
+    void insert(const ArmorObject &object, int i, int bucket);
+    void cellRange(const ArmorObject &object, int &cx0, int &cy0, int &cx1, int &cy1) const;
+
+    float nms_threshold = 0.3f;
+    float vote_min_iou = 0.9f;
+    float vote_conf_error = 0.15f;
+    bool class_aware = false;
+
+    int grid_w = 0;
+    int grid_h = 0;
+    std::vector<Cell> cells;                      // [分桶][网格行][网格列]
+    std::vector<int> touched_cells;               // 本次写入过的网格，下次运行前清空
+    std::vector<std::pair<int, int>> bucket_keys; // 各分桶对应的 (颜色, 类别)
+};
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_NMS_ENGINE_H
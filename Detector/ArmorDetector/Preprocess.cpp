@@ -0,0 +1,486 @@
+#include "Preprocess.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+
+using namespace armor_detector;
+
+/**
+ * @brief Compute source coordinate and weight the same way as cv::resize(INTER_LINEAR).
+ * @param d Destination coordinate.
+ * @param scale Ratio between source size and destination size.
+ * @param size Source size on this axis.
+ * @param s Left/top source coordinate.
+ * @param w Weight of right/bottom sample.
+ */
+static inline void linearCoord(int d, double scale, int size, int &s, float &w)
+{
+    float f = (float)((d + 0.5) * scale - 0.5);
+    s = cvFloor(f);
+    w = f - s;
+    if (s < 0)
+    {
+        s = 0;
+        w = 0.f;
+    }
+    if (s >= size - 1)
+    {
+        s = size - 1;
+        w = 0.f;
+    }
+}
+
+LetterboxGeometry::LetterboxGeometry(int src_w, int src_h, int dst_w, int dst_h)
+{
+    ratio = std::min(dst_w / (src_w * 1.0), dst_h / (src_h * 1.0));
+    unpad_w = ratio * src_w;
+    unpad_h = ratio * src_h;
+    pad_left = (dst_w - unpad_w) / 2;
+    pad_top = (dst_h - unpad_h) / 2;
+}
+
+Eigen::Matrix<float, 3, 3> LetterboxGeometry::transformMatrix() const
+{
+    Eigen::Matrix<float, 3, 3> transform_matrix;
+    transform_matrix << 1.0 / ratio, 0, -pad_left / ratio, 0, 1.0 / ratio, -pad_top / ratio, 0, 0, 1;
+    return transform_matrix;
+}
+
+void LetterboxKernel::prepare(int _src_w, int _src_h, int _dst_w, int _dst_h)
+{
+    if (_src_w == src_w && _src_h == src_h && _dst_w == dst_w && _dst_h == dst_h)
+        return;
+
+    src_w = _src_w;
+    src_h = _src_h;
+    dst_w = _dst_w;
+    dst_h = _dst_h;
+
+    // 与scaledResize保持相同的缩放比例与填充量
+    geometry = LetterboxGeometry(src_w, src_h, dst_w, dst_h);
+    const int unpad_w = geometry.unpad_w;
+    const int unpad_h = geometry.unpad_h;
+
+    const double scale_x = (double)src_w / unpad_w;
+    const double scale_y = (double)src_h / unpad_h;
+
+    x_ofs0.resize(unpad_w);
+    x_ofs1.resize(unpad_w);
+    x_alpha.resize(unpad_w);
+    for (int dx = 0; dx < unpad_w; dx++)
+    {
+        int sx;
+        float fx;
+        linearCoord(dx, scale_x, src_w, sx, fx);
+        x_ofs0[dx] = sx * 3;
+        x_ofs1[dx] = std::min(sx + 1, src_w - 1) * 3;
+        x_alpha[dx] = fx;
+    }
+
+    y_ofs.resize(unpad_h);
+    y_beta.resize(unpad_h);
+    for (int dy = 0; dy < unpad_h; dy++)
+        linearCoord(dy, scale_y, src_h, y_ofs[dy], y_beta[dy]);
+
+    for (int i = 0; i < 2; i++)
+    {
+        row_buf[i].resize(unpad_w * 3);
+        row_idx[i] = -1;
+    }
+}
+
+/**
+ * @brief Horizontally interpolate one interleaved BGR source row into float.
+ * @param src_row Source row.
+ * @param dst_row Interleaved float row of unpad_w * 3 elements.
+ */
+void LetterboxKernel::horizontalPass(const uchar *src_row, float *dst_row) const
+{
+    for (int dx = 0; dx < geometry.unpad_w; dx++)
+    {
+        const uchar *p0 = src_row + x_ofs0[dx];
+        const uchar *p1 = src_row + x_ofs1[dx];
+        const float a = x_alpha[dx];
+        float *q = dst_row + dx * 3;
+        q[0] = p0[0] + (p1[0] - p0[0]) * a;
+        q[1] = p0[1] + (p1[1] - p0[1]) * a;
+        q[2] = p0[2] + (p1[2] - p0[2]) * a;
+    }
+}
+
+void LetterboxKernel::run(const cv::Mat &src, float *dst, int _dst_w, int _dst_h,
+                          Eigen::Matrix<float, 3, 3> &transform_matrix)
+{
+    CV_Assert(src.type() == CV_8UC3);
+    prepare(src.cols, src.rows, _dst_w, _dst_h);
+
+    transform_matrix = geometry.transformMatrix();
+
+    const int unpad_w = geometry.unpad_w;
+    const int unpad_h = geometry.unpad_h;
+    const int pad_left = geometry.pad_left;
+    const int pad_top = geometry.pad_top;
+
+    const int plane = dst_w * dst_h;
+    float *dst_b = dst;
+    float *dst_g = dst + plane;
+    float *dst_r = dst + plane * 2;
+
+    // 上下填充行
+    const int pad_bottom_start = pad_top + unpad_h;
+    for (int c = 0; c < 3; c++)
+    {
+        float *p = dst + c * plane;
+        std::memset(p, 0, sizeof(float) * pad_top * dst_w);
+        std::memset(p + pad_bottom_start * dst_w, 0, sizeof(float) * (dst_h - pad_bottom_start) * dst_w);
+    }
+
+    const int pad_right = dst_w - pad_left - unpad_w;
+    for (int dy = 0; dy < unpad_h; dy++)
+    {
+        const int sy0 = y_ofs[dy];
+        const int sy1 = std::min(sy0 + 1, src_h - 1);
+        const float beta = y_beta[dy];
+
+        // 复用上一行已经插值过的源行
+        if (row_idx[0] != sy0)
+        {
+            if (row_idx[1] == sy0)
+            {
+                std::swap(row_buf[0], row_buf[1]);
+                std::swap(row_idx[0], row_idx[1]);
+            }
+            else
+            {
+                horizontalPass(src.ptr<uchar>(sy0), row_buf[0].data());
+                row_idx[0] = sy0;
+            }
+        }
+        if (row_idx[1] != sy1)
+        {
+            horizontalPass(src.ptr<uchar>(sy1), row_buf[1].data());
+            row_idx[1] = sy1;
+        }
+
+        const float *h0 = row_buf[0].data();
+        const float *h1 = row_buf[1].data();
+        const int row_start = (pad_top + dy) * dst_w;
+        float *ob = dst_b + row_start;
+        float *og = dst_g + row_start;
+        float *orr = dst_r + row_start;
+
+        std::fill(ob, ob + pad_left, 0.f);
+        std::fill(og, og + pad_left, 0.f);
+        std::fill(orr, orr + pad_left, 0.f);
+        ob += pad_left;
+        og += pad_left;
+        orr += pad_left;
+
+        // 垂直插值 + 通道解交错，直接写入三个平面
+        int dx = 0;
+#if CV_SIMD
+        const int VECSZ = CV_SIMD_WIDTH / sizeof(float);
+        const cv::v_float32 v_beta = cv::vx_setall_f32(beta);
+        const cv::v_float32 v_beta1 = cv::vx_setall_f32(1.f - beta);
+        const cv::v_float32 v_zero = cv::vx_setzero_f32();
+        for (; dx <= unpad_w - VECSZ; dx += VECSZ)
+        {
+            cv::v_float32 b0, g0, r0, b1, g1, r1;
+            cv::v_load_deinterleave(h0 + dx * 3, b0, g0, r0);
+            cv::v_load_deinterleave(h1 + dx * 3, b1, g1, r1);
+            cv::v_store(ob + dx, cv::v_fma(b1, v_beta, cv::v_fma(b0, v_beta1, v_zero)));
+            cv::v_store(og + dx, cv::v_fma(g1, v_beta, cv::v_fma(g0, v_beta1, v_zero)));
+            cv::v_store(orr + dx, cv::v_fma(r1, v_beta, cv::v_fma(r0, v_beta1, v_zero)));
+        }
+#endif
+        for (; dx < unpad_w; dx++)
+        {
+            ob[dx] = h0[dx * 3 + 0] * (1.f - beta) + h1[dx * 3 + 0] * beta;
+            og[dx] = h0[dx * 3 + 1] * (1.f - beta) + h1[dx * 3 + 1] * beta;
+            orr[dx] = h0[dx * 3 + 2] * (1.f - beta) + h1[dx * 3 + 2] * beta;
+        }
+
+        std::fill(ob + unpad_w, ob + unpad_w + pad_right, 0.f);
+        std::fill(og + unpad_w, og + unpad_w + pad_right, 0.f);
+        std::fill(orr + unpad_w, orr + unpad_w + pad_right, 0.f);
+    }
+}
+
+/**
+ * @brief Area resampling taps, the same weights as cv::resize(INTER_AREA) when shrinking.
+ * @param src_size Source size on this axis.
+ * @param dst_size Destination size on this axis.
+ * @param begin Start of the taps of each destination element, dst_size + 1 entries.
+ * @param ofs Source element of each tap.
+ * @param w Weight of each tap, the weights of a destination element sum to 1.
+ */
+static void areaTaps(int src_size, int dst_size, std::vector<int> &begin, std::vector<int> &ofs, std::vector<float> &w)
+{
+    const double scale = (double)src_size / dst_size;
+    begin.resize(dst_size + 1);
+    ofs.clear();
+    w.clear();
+    for (int d = 0; d < dst_size; d++)
+    {
+        begin[d] = ofs.size();
+        const double f0 = d * scale;
+        const double f1 = std::min((d + 1) * scale, (double)src_size);
+        for (int s = (int)f0; s < f1; s++)
+        {
+            // 源像素与目标像素区间的重叠长度
+            const double overlap = std::min(f1, s + 1.0) - std::max(f0, (double)s);
+            if (overlap <= 1e-6)
+                continue;
+            ofs.push_back(std::min(s, src_size - 1));
+            w.push_back(overlap / (f1 - f0));
+        }
+    }
+    begin[dst_size] = ofs.size();
+}
+
+// 拜耳排列
+static const struct
+{
+    const char *name;
+    int color[4];
+    int bgr_code;
+} BAYER_FORMATS[] = {
+    // cv::cvtColor 的拜耳命名以第二行第二列开始，与传感器命名相差一个像素
+    {"BGGR", {0, 1, 1, 2}, cv::COLOR_BayerRG2BGR},
+    {"GBRG", {1, 0, 2, 1}, cv::COLOR_BayerGR2BGR},
+    {"GRBG", {1, 2, 0, 1}, cv::COLOR_BayerGB2BGR},
+    {"RGGB", {2, 1, 1, 0}, cv::COLOR_BayerBG2BGR},
+};
+
+bool BayerKernel::setFormat(const std::string &pattern, const cv::Scalar &_gains)
+{
+    for (const auto &format : BAYER_FORMATS)
+    {
+        if (pattern != format.name)
+            continue;
+        std::copy(format.color, format.color + 4, pattern_color);
+        bgr_code = format.bgr_code;
+        for (int c = 0; c < 3; c++)
+            gains[c] = _gains[c];
+        return true;
+    }
+    return false;
+}
+
+bool BayerKernel::valid() const
+{
+    return bgr_code >= 0;
+}
+
+void BayerKernel::prepare(int _cells_w, int _cells_h, int _dst_w, int _dst_h)
+{
+    if (_cells_w == cells_w && _cells_h == cells_h && _dst_w == dst_w && _dst_h == dst_h)
+        return;
+
+    cells_w = _cells_w;
+    cells_h = _cells_h;
+    dst_w = _dst_w;
+    dst_h = _dst_h;
+
+    // 缩放比例与填充按原始像素尺寸计算，变换矩阵直接对应原始图像坐标
+    geometry = LetterboxGeometry(cells_w * 2, cells_h * 2, dst_w, dst_h);
+    areaTaps(cells_w, geometry.unpad_w, x_tap_begin, x_tap_ofs, x_tap_w);
+    areaTaps(cells_h, geometry.unpad_h, y_tap_begin, y_tap_ofs, y_tap_w);
+
+    for (int c = 0; c < 3; c++)
+    {
+        cell_buf[c].resize(cells_w);
+        row_buf[c].resize(geometry.unpad_w);
+    }
+}
+
+/**
+ * @brief Merge one row of 2x2 cells into white balanced planar BGR.
+ * @param row0 Upper source row of the cells.
+ * @param row1 Lower source row of the cells.
+ * @param color Color at each position of a cell, row by row.
+ */
+void BayerKernel::demosaicRow(const uchar *row0, const uchar *row1, const int *color)
+{
+    // 单元内各颜色的位置，两个绿色像素取平均
+    int pos[4];
+    for (int i = 0, g = 1; i < 4; i++)
+        pos[color[i] == 1 ? g++ : color[i] == 0 ? 0 : 3] = i;
+    const float gain_b = gains[0];
+    const float gain_g = gains[1] * 0.5f;
+    const float gain_r = gains[2];
+    float *cb = cell_buf[0].data();
+    float *cg = cell_buf[1].data();
+    float *cr = cell_buf[2].data();
+
+    int x = 0;
+#if CV_SIMD
+    // 每个16位通道恰好装下一行中的一个单元，移位即可拆出左右两个像素
+    const int VECSZ = CV_SIMD_WIDTH / sizeof(ushort);
+    const cv::v_float32 v_gain_b = cv::vx_setall_f32(gain_b);
+    const cv::v_float32 v_gain_g = cv::vx_setall_f32(gain_g);
+    const cv::v_float32 v_gain_r = cv::vx_setall_f32(gain_r);
+    const cv::v_float32 v_max = cv::vx_setall_f32(255.f);
+    const cv::v_float32 v_zero = cv::vx_setzero_f32();
+    auto store = [&](const cv::v_uint16 &v, const cv::v_float32 &gain, float *dst) {
+        cv::v_uint32 lo, hi;
+        cv::v_expand(v, lo, hi);
+        cv::v_store(dst, cv::v_min(cv::v_fma(cv::v_cvt_f32(cv::v_reinterpret_as_s32(lo)), gain, v_zero), v_max));
+        cv::v_store(dst + VECSZ / 2,
+                    cv::v_min(cv::v_fma(cv::v_cvt_f32(cv::v_reinterpret_as_s32(hi)), gain, v_zero), v_max));
+    };
+    for (; x <= cells_w - VECSZ; x += VECSZ)
+    {
+        const cv::v_uint16 w0 = cv::vx_load((const ushort *)(row0 + x * 2));
+        const cv::v_uint16 w1 = cv::vx_load((const ushort *)(row1 + x * 2));
+        const cv::v_uint16 v[4] = {cv::v_shr<8>(cv::v_shl<8>(w0)), cv::v_shr<8>(w0), cv::v_shr<8>(cv::v_shl<8>(w1)),
+                                   cv::v_shr<8>(w1)};
+        store(v[pos[0]], v_gain_b, cb + x);
+        store(cv::v_add_wrap(v[pos[1]], v[pos[2]]), v_gain_g, cg + x);
+        store(v[pos[3]], v_gain_r, cr + x);
+    }
+#endif
+    for (; x < cells_w; x++)
+    {
+        const uchar v[4] = {row0[x * 2], row0[x * 2 + 1], row1[x * 2], row1[x * 2 + 1]};
+        cb[x] = std::min(v[pos[0]] * gain_b, 255.f);
+        cg[x] = std::min((v[pos[1]] + v[pos[2]]) * gain_g, 255.f);
+        cr[x] = std::min(v[pos[3]] * gain_r, 255.f);
+    }
+}
+
+/**
+ * @brief Area resample the merged cell row to the width of the unpadded network input.
+ */
+void BayerKernel::horizontalPass(float *dst_b, float *dst_g, float *dst_r) const
+{
+    const float *cb = cell_buf[0].data();
+    const float *cg = cell_buf[1].data();
+    const float *cr = cell_buf[2].data();
+    for (int dx = 0; dx < geometry.unpad_w; dx++)
+    {
+        float b = 0.f, g = 0.f, r = 0.f;
+        for (int t = x_tap_begin[dx]; t < x_tap_begin[dx + 1]; t++)
+        {
+            const int sx = x_tap_ofs[t];
+            const float w = x_tap_w[t];
+            b += cb[sx] * w;
+            g += cg[sx] * w;
+            r += cr[sx] * w;
+        }
+        dst_b[dx] = b;
+        dst_g[dx] = g;
+        dst_r[dx] = r;
+    }
+}
+
+void BayerKernel::run(const cv::Mat &src, float *dst, int _dst_w, int _dst_h,
+                      Eigen::Matrix<float, 3, 3> &transform_matrix)
+{
+    CV_Assert(src.type() == CV_8UC1 && valid());
+
+    // ROI起点为奇数时滤色片相位随之平移
+    cv::Size whole;
+    cv::Point ofs;
+    src.locateROI(whole, ofs);
+    int color[4];
+    for (int i = 0; i < 4; i++)
+        color[i] = pattern_color[(((i >> 1) + ofs.y) & 1) * 2 + (((i & 1) + ofs.x) & 1)];
+
+    // 单元合成使分辨率减半，网络输入比单元网格大时（ROI、分块等原始分辨率裁剪）改为完整去马赛克
+    const LetterboxGeometry cell_geometry(src.cols / 2 * 2, src.rows / 2 * 2, _dst_w, _dst_h);
+    if (cell_geometry.unpad_w > src.cols / 2 || cell_geometry.unpad_h > src.rows / 2)
+    {
+        demosaicCrop(src, color);
+        letterbox.run(crop_bgr, dst, _dst_w, _dst_h, transform_matrix);
+        return;
+    }
+
+    prepare(src.cols / 2, src.rows / 2, _dst_w, _dst_h);
+    transform_matrix = geometry.transformMatrix();
+
+    const int unpad_w = geometry.unpad_w;
+    const int unpad_h = geometry.unpad_h;
+    const int pad_left = geometry.pad_left;
+    const int pad_top = geometry.pad_top;
+    const int pad_right = dst_w - pad_left - unpad_w;
+    const int plane = dst_w * dst_h;
+
+    // 上下填充行
+    const int pad_bottom_start = pad_top + unpad_h;
+    for (int c = 0; c < 3; c++)
+    {
+        float *p = dst + c * plane;
+        std::memset(p, 0, sizeof(float) * pad_top * dst_w);
+        std::memset(p + pad_bottom_start * dst_w, 0, sizeof(float) * (dst_h - pad_bottom_start) * dst_w);
+    }
+
+    row_idx = -1;
+    for (int dy = 0; dy < unpad_h; dy++)
+    {
+        float *out[3];
+        for (int c = 0; c < 3; c++)
+        {
+            out[c] = dst + c * plane + (pad_top + dy) * dst_w;
+            std::fill(out[c], out[c] + pad_left, 0.f);
+            std::fill(out[c] + pad_left + unpad_w, out[c] + pad_left + unpad_w + pad_right, 0.f);
+            out[c] += pad_left;
+        }
+
+        // 按覆盖面积累加各单元行，相邻输出行共享的单元行只处理一次
+        for (int t = y_tap_begin[dy]; t < y_tap_begin[dy + 1]; t++)
+        {
+            const int sy = y_tap_ofs[t];
+            if (row_idx != sy)
+            {
+                demosaicRow(src.ptr<uchar>(sy * 2), src.ptr<uchar>(sy * 2 + 1), color);
+                horizontalPass(row_buf[0].data(), row_buf[1].data(), row_buf[2].data());
+                row_idx = sy;
+            }
+
+            const float w = y_tap_w[t];
+            const bool first = t == y_tap_begin[dy];
+            for (int c = 0; c < 3; c++)
+            {
+                const float *h = row_buf[c].data();
+                float *o = out[c];
+                int dx = 0;
+#if CV_SIMD
+                const int VECSZ = CV_SIMD_WIDTH / sizeof(float);
+                const cv::v_float32 v_w = cv::vx_setall_f32(w);
+                const cv::v_float32 v_zero = cv::vx_setzero_f32();
+                for (; dx <= unpad_w - VECSZ; dx += VECSZ)
+                    cv::v_store(o + dx, cv::v_fma(cv::vx_load(h + dx), v_w, first ? v_zero : cv::vx_load(o + dx)));
+#endif
+                for (; dx < unpad_w; dx++)
+                    o[dx] = h[dx] * w + (first ? 0.f : o[dx]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Full resolution white balanced demosaic of a crop into crop_bgr.
+ * @param color Color at each position of the top-left cell of the crop, row by row.
+ */
+void BayerKernel::demosaicCrop(const cv::Mat &src, const int *color)
+{
+    int code = bgr_code;
+    for (const auto &format : BAYER_FORMATS)
+    {
+        if (std::equal(format.color, format.color + 4, color))
+            code = format.bgr_code;
+    }
+    cv::cvtColor(src, crop_bgr, code);
+    cv::multiply(crop_bgr, cv::Scalar(gains[0], gains[1], gains[2]), crop_bgr);
+}
+
+void BayerKernel::toBgr(const cv::Mat &src, cv::Mat &bgr) const
+{
+    CV_Assert(src.type() == CV_8UC1 && valid());
+    cv::Mat demosaiced;
+    cv::cvtColor(src, demosaiced, bgr_code);
+    cv::multiply(demosaiced, cv::Scalar(gains[0], gains[1], gains[2]), bgr);
+}
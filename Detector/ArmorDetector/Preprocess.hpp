@@ -0,0 +1,147 @@
+#ifndef YOLOXARMOR_PREPROCESS_H
+#define YOLOXARMOR_PREPROCESS_H
+
+#include <eigen3/Eigen/Core>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+namespace armor_detector
+{
+
+/**
+ * @brief Letterbox缩放参数（保持宽高比缩放后居中填充）
+ */
+struct LetterboxGeometry
+{
+    float ratio = 1.f; // 缩放比例
+    int unpad_w = 0;   // 缩放后有效图像宽度
+    int unpad_h = 0;   // 缩放后有效图像高度
+    int pad_left = 0;  // 左侧填充
+    int pad_top = 0;   // 上方填充
+
+    LetterboxGeometry() = default;
+    LetterboxGeometry(int src_w, int src_h, int dst_w, int dst_h);
+
+    /**
+     * @brief Transform from network coordinates back to source coordinates.
+     */
+    Eigen::Matrix<float, 3, 3> transformMatrix() const;
+};
+
+/**
+ * @brief 融合的letterbox预处理：一次遍历完成双线性缩放、边缘填充与BGR转平面float(CHW)
+ *
+ * 与 cv::resize(INTER_LINEAR) + cv::copyMakeBorder + convertTo + split + memcpy 的结果一致，
+ * 但只读取参与插值的源图像行，直接写入网络输入张量，稳态下不进行堆内存分配。
+ */
+class LetterboxKernel
+{
+  public:
+    /**
+     * @brief Letterbox an 8-bit BGR image straight into planar float network input.
+     * @param src Source image (CV_8UC3).
+     * @param dst Network input memory, 3 * dst_w * dst_h floats in CHW order.
+     * @param dst_w Width of network input.
+     * @param dst_h Height of network input.
+     * @param transform_matrix Transform from network coordinates back to source coordinates.
+     */
+    void run(const cv::Mat &src, float *dst, int dst_w, int dst_h, Eigen::Matrix<float, 3, 3> &transform_matrix);
+
+  private:
+    void prepare(int src_w, int src_h, int dst_w, int dst_h);
+    void horizontalPass(const uchar *src_row, float *dst_row) const;
+
+    int src_w = 0;
+    int src_h = 0;
+    int dst_w = 0;
+    int dst_h = 0;
+
+    LetterboxGeometry geometry;
+
+    std::vector<int> x_ofs0;    // 左侧采样点在源行中的字节偏移
+    std::vector<int> x_ofs1;    // 右侧采样点在源行中的字节偏移
+    std::vector<float> x_alpha; // 水平插值权重
+    std::vector<int> y_ofs;     // 上方采样行
+    std::vector<float> y_beta;  // 垂直插值权重
+
+    std::vector<float> row_buf[2]; // 水平插值后的交错BGR行缓存
+    int row_idx[2] = {-1, -1};     // 行缓存对应的源图像行号
+};
+
+/**
+ * @brief 融合的拜耳预处理：一次遍历完成去马赛克、白平衡、面积缩放与letterbox，直接写入平面float(CHW)
+ *
+ * 每个2x2拜耳单元合成一个BGR像素（绿色取两个绿色像素的平均），再按覆盖面积加权缩放到网络输入。
+ * 网络输入远小于传感器分辨率时，与完整去马赛克后再缩小的结果相近，但每个原始像素只读取一次，不生成全分辨率BGR图像。
+ * 缩小时结果与 单元合成 + cv::resize(INTER_AREA) + cv::copyMakeBorder + split 一致。
+ * 网络输入大于单元网格时（ROI、分块等原始分辨率裁剪）单元合成会损失分辨率，改为完整去马赛克后经 LetterboxKernel 缩放。
+ */
+class BayerKernel
+{
+  public:
+    /**
+     * @brief Set the color filter layout and the white balance gains.
+     * @param pattern Colors of the top-left 2x2 cell read row by row: "BGGR", "GBRG", "GRBG" or "RGGB".
+     * @param gains White balance gains in B, G, R order.
+     * @return False if the pattern is unknown.
+     */
+    bool setFormat(const std::string &pattern, const cv::Scalar &gains);
+
+    /**
+     * @brief Whether a valid format has been set.
+     */
+    bool valid() const;
+
+    /**
+     * @brief Demosaic, white balance and letterbox an 8-bit Bayer image straight into planar float network input.
+     * @param src Source image (CV_8UC1), may be a ROI of a larger frame, the filter phase follows the ROI offset.
+     * @param dst Network input memory, 3 * dst_w * dst_h floats in CHW order.
+     * @param dst_w Width of network input.
+     * @param dst_h Height of network input.
+     * @param transform_matrix Transform from network coordinates back to source coordinates.
+     */
+    void run(const cv::Mat &src, float *dst, int dst_w, int dst_h, Eigen::Matrix<float, 3, 3> &transform_matrix);
+
+    /**
+     * @brief Full resolution white balanced BGR image, only for display and recording.
+     * @param src Source image (CV_8UC1) with the filter phase of the full frame.
+     * @param bgr Output image (CV_8UC3).
+     */
+    void toBgr(const cv::Mat &src, cv::Mat &bgr) const;
+
+  private:
+    void prepare(int cells_w, int cells_h, int dst_w, int dst_h);
+    void demosaicRow(const uchar *row0, const uchar *row1, const int *color);
+    void horizontalPass(float *dst_b, float *dst_g, float *dst_r) const;
+    void demosaicCrop(const cv::Mat &src, const int *color);
+
+    int pattern_color[4] = {-1, -1, -1, -1}; // 左上2x2单元各位置的颜色，0 B / 1 G / 2 R
+    float gains[3] = {1.f, 1.f, 1.f};        // 白平衡增益 B G R
+    int bgr_code = -1;                       // 全分辨率转换使用的 cv::cvtColor 代码
+
+    int cells_w = 0; // 拜耳单元列数
+    int cells_h = 0; // 拜耳单元行数
+    int dst_w = 0;
+    int dst_h = 0;
+
+    LetterboxGeometry geometry;
+
+    std::vector<int> x_tap_begin; // 各输出列在 x_tap_ofs / x_tap_w 中的起始位置
+    std::vector<int> x_tap_ofs;   // 覆盖的单元列
+    std::vector<float> x_tap_w;   // 覆盖面积权重
+    std::vector<int> y_tap_begin; // 各输出行在 y_tap_ofs / y_tap_w 中的起始位置
+    std::vector<int> y_tap_ofs;   // 覆盖的单元行
+    std::vector<float> y_tap_w;   // 覆盖面积权重
+
+    std::vector<float> cell_buf[3]; // 一行单元合成后的平面BGR
+    std::vector<float> row_buf[3];  // 水平缩放后的平面BGR行缓存
+    int row_idx = -1;               // 行缓存对应的单元行号
+
+    LetterboxKernel letterbox; // 完整去马赛克后的缩放
+    cv::Mat crop_bgr;          // 完整去马赛克的裁剪图像（复用内存）
+};
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_PREPROCESS_H
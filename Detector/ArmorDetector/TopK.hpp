@@ -0,0 +1,31 @@
+#ifndef YOLOXARMOR_TOPK_H
+#define YOLOXARMOR_TOPK_H
+
+#include <algorithm>
+#include <vector>
+
+namespace armor_detector
+{
+
+/**
+ * @brief 保留置信度最高的k个候选并按置信度降序排列
+ *
+ * 单线程、原地完成：先用 nth_element 选出前k个，再只对保留的候选排序。
+ * @param objects Proposals with a prob member, truncated to at most k elements.
+ * @param k Number of proposals to keep.
+ */
+template <typename T> void selectTopK(std::vector<T> &objects, size_t k)
+{
+    auto greater = [](const T &a, const T &b) { return a.prob > b.prob; };
+
+    if (objects.size() > k)
+    {
+        std::nth_element(objects.begin(), objects.begin() + k, objects.end(), greater);
+        objects.erase(objects.begin() + k, objects.end());
+    }
+    std::sort(objects.begin(), objects.end(), greater);
+}
+
+} // namespace armor_detector
+
+#endif // YOLOXARMOR_TOPK_H
@@ -109,7 +109,7 @@ float PoseSolver::calculateDistanceToCenter(const cv::Point2f &image_point)
 
 void PoseSolver::solvePose(armor_detector::ArmorObject armor, msg::Armor armor_msg)
 {
-    PoseSolver::getImgpPoints(armor.pts);
+    PoseSolver::getImgpPoints(std::vector<cv::Point2f>(armor.apex, armor.apex + 4));
     if (imagePoints.size() == 0)
     {
         cout << "未获取到图像点" << endl;
@@ -167,6 +167,19 @@ void PoseSolver::solvePose(armor_detector::ArmorObject armor, msg::Armor armor_m
     cout << "Quaternion:\n" << armor_msg.pose.orientation << endl;
 }
 
+float PoseSolver::solveDistance(const armor_detector::ArmorObject &armor)
+{
+    std::vector<cv::Point2f> image_points(armor.apex, armor.apex + 4);
+    const std::vector<cv::Point3f> &obj_points = armor.distinguish == bigArmor ? bigObjPoints : smallObjPoints;
+    cv::Mat distance_rvec, distance_tvec;
+    if (!solvePnP(obj_points, image_points, instantMatrix, distortionCoeffs, distance_rvec, distance_tvec, false,
+                  SOLVEPNP_IPPE))
+        return 0.f;
+
+    pnp_results.distance = static_cast<float>(cv::norm(distance_tvec));
+    return pnp_results.distance;
+}
+
 float PoseSolver::getYawAngle()
 {
     return pnp_results.yaw_angle;
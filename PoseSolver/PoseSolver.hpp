@@ -53,6 +53,9 @@ class PoseSolver
     void getImgpPoints(std::vector<cv::Point2f> image_points);
     void solvePose(armor_detector::ArmorObject armor, msg::Armor armor_msg);
 
+    // 只解算距离，不输出调试信息，用于逐帧调整识别分辨率
+    float solveDistance(const armor_detector::ArmorObject &armor);
+
     float getYawAngle();
 
     float getPitchAngle();
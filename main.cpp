@@ -13,49 +13,138 @@
 #define DBG std::cout << __FILE__ << ":" << __LINE__ << ":" << __TIME__ << std::endl;
 #endif
 
+#ifdef USE_MVSDK
 #include "Camera/MVCamera.hpp"
+#endif
+#include "Camera/ReplaySource.hpp"
 #include "Detector/ArmorDetector/ArmorDetector.hpp"
+#include "PoseSolver/PoseSolver.hpp"
 #include "Utils/msg.hpp"
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <opencv2/opencv.hpp>
 
 msg::Armor armor_msg;
 msg::Armors armors_msg;
 
 // Main code
-int main(int, char **)
+// 用法: 606Vision [视频文件 | 图像目录] [realtime | fast]，不指定时使用工业相机
+int main(int argc, char **argv)
 {
-    // 初始化相机
-    mindvision::MVCamera *mv_capture_ = new mindvision::MVCamera(
-        mindvision::CameraParam(0, mindvision::RESOLUTION_1280_X_1024, mindvision::EXPOSURE_5000));
+    auto start_time = std::chrono::steady_clock::now();
+
+    // 初始化图像源：回放按录制时间戳（realtime）或尽快（fast）发布，不需要相机
+    std::unique_ptr<FrameSource> frame_source_;
+    if (argc > 1)
+    {
+        bool realtime = !(argc > 2 && std::string(argv[2]) == "fast");
+        frame_source_ = std::make_unique<ReplaySource>(argv[1], realtime);
+    }
+#ifdef USE_MVSDK
+    else
+    {
+        mindvision::CameraParam camera_param(0, mindvision::RESOLUTION_1280_X_1024, mindvision::EXPOSURE_5000);
+        frame_source_ = std::make_unique<mindvision::MVCamera>(camera_param);
+    }
+#endif
+    if (!frame_source_ || frame_source_->frameSize().empty())
+    {
+        std::cout << "Usage: " << argv[0] << " [video file | image dir] [realtime | fast]" << std::endl;
+        return 1;
+    }
     cv::Mat src_img_;
 
     std::vector<cv::Point2f> image_points;
     std::vector<armor_detector::ArmorObject> objects;
 
-    // 初始化网络模型
+    // 初始化网络模型，识别器配置中的 MODEL 可替换该模型（如 BACKEND 为 OPENCV 时使用 ONNX 模型）
     const string network_path = "Detector/model/opt-0517-001.xml";
-    armor_detector::ArmorDetector armor_detector(network_path);
+    const string detector_config_path = "Configs/detector/detector.xml";
+    armor_detector::ArmorDetector armor_detector(network_path, detector_config_path);
+    // 相机输出拜耳原始图像时，去马赛克与白平衡在缩放到网络输入时完成
+    if (!frame_source_->bayerPattern().empty())
+        armor_detector.setBayerInput(frame_source_->bayerPattern(), frame_source_->whiteBalance());
+    armor_detector.warmup(frame_source_->frameSize());
+    PoseSolver pose_solver("Configs/pose_solver/camera_params.xml", 1);
+    bool first_detection = true;
+
+    cv::Mat result_img;
+    int64_t frame_count = 0;
+    std::chrono::steady_clock::time_point frame_ready;
+    double ready_latency_sum = 0, ready_latency_max = 0;
+    auto window_start = std::chrono::steady_clock::now();
 
+    // 处理取回的一帧识别结果
+    auto handleResult = [&]() {
+        if (first_detection && !objects.empty())
+        {
+            first_detection = false;
+            auto first_time = std::chrono::steady_clock::now();
+            std::cout << "Time to first detection: "
+                      << std::chrono::duration<double, std::milli>(first_time - start_time).count() << " ms"
+                      << std::endl;
+        }
 
-    while (mv_capture_->isCameraOnline())
+        // 目标距离用于选择下一帧的输入分辨率
+        if (armor_detector.isFindTarget())
+        {
+            armor_detector.setTargetDistance(pose_solver.solveDistance(armor_detector.getTarget()));
+        }
+
+        // 全分辨率BGR只在显示时生成
+        armor_detector.toBgr(result_img, result_img);
+        for (auto armor_object : objects)
+        {
+            armor_detector.display(result_img, armor_object); // 识别结果可视化
+        }
+
+        // ROI模式下绘制推理窗口
+        cv::Rect roi = armor_detector.lastRoi();
+        if (roi.width < result_img.cols || roi.height < result_img.rows)
+            cv::rectangle(result_img, roi, {255, 255, 0}, 2);
+
+        imshow("output", result_img);
+        cv::waitKey(1);
+    };
+
+    // 采集与推理并行，每次只取最新一帧
+    frame_source_->startCapture();
+    while (frame_source_->latestFrame(src_img_, &frame_ready))
     {
-        src_img_ = mv_capture_->image();
         // do something
 
-        if (armor_detector.detect(src_img_, objects))
+        // 相机交付该帧到开始识别的延迟
+        double ready_latency =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_ready).count();
+        ready_latency_sum += ready_latency;
+        ready_latency_max = std::max(ready_latency_max, ready_latency);
+
+        // 当前帧推理的同时解码上一帧的结果
+        armor_detector.submit(src_img_);
+        src_img_.release();
+
+        if (++frame_count % 1000 == 0)
         {
-            for (auto armor_object : objects)
-            {
-                armor_detector.display(src_img_, armor_object); // 识别结果可视化
-            }
+            auto now = std::chrono::steady_clock::now();
+            std::cout << "Frames: " << frame_count << ", dropped: " << frame_source_->droppedFrames() << ", "
+                      << 1000 / std::chrono::duration<double>(now - window_start).count()
+                      << " fps, frame ready to detect: " << ready_latency_sum / 1000 << " ms avg, "
+                      << ready_latency_max << " ms max" << std::endl;
+            ready_latency_sum = ready_latency_max = 0;
+            window_start = now;
         }
 
-        imshow("output", src_img_);
-        cv::waitKey(1);
+        if (armor_detector.inFlight() < armor_detector.pipelineDepth())
+            continue;
 
-        mv_capture_->releaseBuff();
+        if (armor_detector.poll(objects, &result_img))
+            handleResult();
     }
 
+    // 回放结束后取回仍在推理中的帧，保证每帧的结果都被处理
+    while (armor_detector.inFlight() > 0 && armor_detector.poll(objects, &result_img))
+        handleResult();
+
     return 0;
 }